@@ -0,0 +1,95 @@
+#include "adaptive_grid.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    // the number of steps between checks of the fill ratio.
+    constexpr int k_check_interval = 8;
+
+    double fill_ratio(const asf::grid_stats& stats) {
+        double area = 3.0 * stats.radius * (stats.radius + 1) + 1.0;
+        return stats.live_count / area;
+    }
+
+}
+
+asf::adaptive_automaton::adaptive_automaton(const hex_grid& seed, const state_table& tbl,
+            int radius, const switching_params& params) :
+        tbl_(tbl),
+        radius_(radius),
+        params_(params),
+        parallel_(false),
+        usage_{ 0, 0, 0 } {
+
+    sparse_.emplace(seed, tbl_, radius_);
+    if (wants_dense(sparse_->stats())) {
+        sparse_.reset();
+        use_dense(seed);
+    }
+}
+
+void asf::adaptive_automaton::set_parallel(bool enabled) {
+    parallel_ = enabled;
+    if (dense_) {
+        dense_->set_parallel(enabled);
+    }
+}
+
+// a sparse grid moves to the dense representation once it is dense_fill_ratio full and
+// min_dense_radius across; a dense grid moves back once it is less than sparse_fill_ratio full.
+bool asf::adaptive_automaton::wants_dense(const grid_stats& stats) const {
+    if (dense_) {
+        return fill_ratio(stats) >= params_.sparse_fill_ratio;
+    }
+    return stats.radius >= params_.min_dense_radius &&
+        fill_ratio(stats) >= params_.dense_fill_ratio;
+}
+
+void asf::adaptive_automaton::use_dense(const hex_grid& grid) {
+    dense_.emplace(grid, tbl_, radius_);
+    dense_->set_parallel(parallel_);
+}
+
+void asf::adaptive_automaton::step() {
+    if (dense_) {
+        dense_->step();
+        ++usage_.dense_steps;
+    } else {
+        sparse_->step();
+        ++usage_.sparse_steps;
+    }
+
+    if ((usage_.sparse_steps + usage_.dense_steps) % k_check_interval != 0) {
+        return;
+    }
+    bool dense = dense_.has_value();
+    if (wants_dense(stats()) == dense) {
+        return;
+    }
+    auto grid = to_hex_grid();
+    if (dense) {
+        dense_.reset();
+        sparse_.emplace(grid, tbl_, radius_);
+    } else {
+        sparse_.reset();
+        use_dense(grid);
+    }
+    ++usage_.switches;
+}
+
+uint64_t asf::adaptive_automaton::hash() const {
+    return dense_ ? dense_->hash() : sparse_->hash();
+}
+
+asf::grid_stats asf::adaptive_automaton::stats() const {
+    return dense_ ? dense_->stats() : sparse_->stats();
+}
+
+asf::hex_grid asf::adaptive_automaton::to_hex_grid() const {
+    return dense_ ? dense_->to_hex_grid() : sparse_->to_hex_grid();
+}
+
+asf::representation_use asf::adaptive_automaton::usage() const {
+    return usage_;
+}
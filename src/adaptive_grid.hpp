@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "sparse_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // the fill ratios at which the adaptive engine moves a run between its sparse and dense
+    // representations, and the bounding radius below which it stays sparse.
+    struct switching_params {
+        double dense_fill_ratio;
+        double sparse_fill_ratio;
+        int    min_dense_radius;
+    };
+
+    // how many steps of a run were taken on each representation, and how many times the
+    // run moved from one to the other.
+    struct representation_use {
+        int sparse_steps;
+        int dense_steps;
+        int switches;
+    };
+
+    // runs the cellular automaton on a sparse automaton while the snowflake fills little of
+    // the hexagon it spans and on a dense automaton while it fills much of it. A cycle that
+    // spans a switch goes unnoticed, as the two hash their grids differently.
+
+    class adaptive_automaton {
+    public:
+        adaptive_automaton(const hex_grid& seed, const state_table& tbl, int radius,
+            const switching_params& params);
+
+        void set_parallel(bool enabled);
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        hex_grid to_hex_grid() const;
+        representation_use usage() const;
+
+    private:
+        bool wants_dense(const grid_stats& stats) const;
+        void use_dense(const hex_grid& grid);
+
+        state_table tbl_;
+        int radius_;
+        switching_params params_;
+        bool parallel_;
+        std::optional<sparse_automaton> sparse_;
+        std::optional<dense_automaton> dense_;
+        representation_use usage_;
+    };
+
+}
@@ -0,0 +1,177 @@
+#include "batch_grid.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_guard = 1;
+    constexpr int k_max_lanes = 32;
+    constexpr long k_default_l2_size = 512 * 1024;
+
+    int vector_bytes() {
+#if defined(ASF_AVX2_KERNEL) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        if (__builtin_cpu_supports("avx2")) {
+            return 32;
+        }
+#endif
+        return 16;
+    }
+
+    long l2_cache_size() {
+#if defined(__unix__) && defined(_SC_LEVEL2_CACHE_SIZE)
+        long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0) {
+            return size;
+        }
+#endif
+        return k_default_l2_size;
+    }
+
+}
+
+int asf::batch_lanes(int radius) {
+    // a step streams through the grids row by row, reading three rows of the current
+    // grid and writing one row of the next, so those four rows, for every lane, are the
+    // working set that should stay in half of the L2 cache.
+    long row_bytes = 2 * (radius + k_guard) + 1;
+    int lanes = vector_bytes();
+    while (lanes > 1 && 4 * row_bytes * lanes > l2_cache_size() / 2) {
+        lanes /= 2;
+    }
+    return lanes;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::batch_automaton::batch_automaton(int radius, int num_states, int lanes) :
+        radius_(radius),
+        stride_(2 * (radius + k_guard) + 1),
+        lanes_(static_cast<int>(std::bit_ceil(static_cast<unsigned>(std::clamp(lanes, 1, k_max_lanes))))),
+        rules_size_(num_states * num_sums(num_states)),
+        rules_stride_(num_sums(num_states)),
+        extent_(0),
+        current_(static_cast<size_t>(stride_) * stride_ * lanes_, 0),
+        next_(current_.size(), 0),
+        rules_(static_cast<size_t>(rules_size_) * lanes_, 0),
+        stats_(lanes_, grid_stats{ 0, 0 }),
+        changed_(lanes_, 0) {
+
+    switch (lanes_) {
+        case 1: sweep_ = &batch_automaton::sweep<1>; break;
+        case 2: sweep_ = &batch_automaton::sweep<2>; break;
+        case 4: sweep_ = &batch_automaton::sweep<4>; break;
+        case 8: sweep_ = &batch_automaton::sweep<8>; break;
+        case 16: sweep_ = &batch_automaton::sweep<16>; break;
+        default: sweep_ = &batch_automaton::sweep<32>; break;
+    }
+}
+
+int asf::batch_automaton::index(const hex_coords& hex) const {
+    return (hex.y + radius_ + k_guard) * stride_ + (hex.x + radius_ + k_guard);
+}
+
+void asf::batch_automaton::load(int lane, const hex_grid& seed, const state_table& tbl) {
+    if (tbl.stride() != rules_stride_) {
+        throw std::runtime_error("all candidates of a batch must have the same number of states");
+    }
+
+    auto rules = flat_rules(tbl);
+    std::copy(rules.begin(), rules.end(), rules_.begin() + static_cast<size_t>(lane) * rules_size_);
+
+    grid_stats stats = { 0, 0 };
+    for (const auto& [hex, state] : seed) {
+        if (distance_from_origin(hex) > radius_) {
+            throw std::runtime_error("cell lies outside of batch grid");
+        }
+        current_[static_cast<size_t>(index(hex)) * lanes_ + lane] = static_cast<uint8_t>(state);
+        if (state > 0) {
+            ++stats.live_count;
+            stats.radius = std::max(stats.radius, distance_from_origin(hex));
+        }
+    }
+    stats_[lane] = stats;
+    extent_ = std::max(extent_, stats.radius);
+}
+
+template<int K>
+void asf::batch_automaton::sweep(int extent) {
+    const uint8_t* rules = rules_.data();
+    const int up = -stride_ * K;
+    const int down = stride_ * K;
+
+    std::array<int, K> live = {};
+    std::array<int, K> radius = {};
+    std::array<uint8_t, K> changed = {};
+
+    for (int row = -extent; row <= extent; ++row) {
+        int first_col = std::max(-extent, -extent - row);
+        int last_col = std::min(extent, extent - row);
+        size_t first = static_cast<size_t>(index({ first_col, row, -first_col - row })) * K;
+        const uint8_t* src = current_.data() + first;
+        uint8_t* dst = next_.data() + first;
+
+        for (int col = first_col; col <= last_col; ++col, src += K, dst += K) {
+            // the sums are the same adds for every lane, so this loop vectorizes; the
+            // lookups that follow are a gather, each lane reading its own state table.
+            std::array<uint8_t, K> sum;
+            for (int k = 0; k < K; ++k) {
+                sum[k] = src[k + K] + src[k - K] + src[k + up] + src[k + up + K] +
+                    src[k + down] + src[k + down - K];
+            }
+            int dist = distance_from_origin({ col, row, -col - row });
+            for (int k = 0; k < K; ++k) {
+                auto next = rules[k * rules_size_ + src[k] * rules_stride_ + sum[k]];
+                dst[k] = next;
+                changed[k] |= (next != src[k]);
+                live[k] += (next != 0);
+                radius[k] = (next != 0) ? std::max(radius[k], dist) : radius[k];
+            }
+        }
+    }
+
+    for (int k = 0; k < K; ++k) {
+        stats_[k] = { live[k], radius[k] };
+        changed_[k] = changed[k];
+    }
+}
+
+void asf::batch_automaton::step() {
+    int extent = std::min(extent_ + 1, radius_);
+    (this->*sweep_)(extent);
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+int asf::batch_automaton::lanes() const {
+    return lanes_;
+}
+
+asf::grid_stats asf::batch_automaton::stats(int lane) const {
+    return stats_[lane];
+}
+
+bool asf::batch_automaton::changed(int lane) const {
+    return changed_[lane] != 0;
+}
+
+asf::hex_grid asf::batch_automaton::to_hex_grid(int lane) const {
+    hex_grid grid;
+    for (int row = -extent_; row <= extent_; ++row) {
+        for (int col = std::max(-extent_, -extent_ - row); col <= std::min(extent_, extent_ - row);
+                ++col) {
+            hex_coords hex = { col, row, -col - row };
+            auto state = current_[static_cast<size_t>(index(hex)) * lanes_ + lane];
+            if (state > 0) {
+                grid[hex] = state;
+            }
+        }
+    }
+    return grid;
+}
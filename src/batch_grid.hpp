@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // the number of candidates to run in one batch for grids of the given radius: one per
+    // byte lane of the widest vector registers, but few enough to stay in the L2 cache.
+    int batch_lanes(int radius);
+
+    // runs the cellular automata of several candidates, each with its own seed and state
+    // table, in lockstep on one pair of dense grids whose cells interleave the candidates.
+
+    class batch_automaton {
+    public:
+        batch_automaton(int radius, int num_states, int lanes);
+
+        void load(int lane, const hex_grid& seed, const state_table& tbl);
+        void step();
+
+        int lanes() const;
+        grid_stats stats(int lane) const;
+        bool changed(int lane) const;
+        hex_grid to_hex_grid(int lane) const;
+
+    private:
+        using sweep_fn = void (batch_automaton::*)(int extent);
+
+        template<int K>
+        void sweep(int extent);
+        int index(const hex_coords& hex) const;
+
+        int radius_;
+        int stride_;
+        int lanes_;
+        int rules_size_;
+        int rules_stride_;
+        int extent_;
+        std::vector<uint8_t> current_;
+        std::vector<uint8_t> next_;
+        std::vector<uint8_t> rules_;
+        std::vector<grid_stats> stats_;
+        std::vector<uint8_t> changed_;
+        sweep_fn sweep_;
+    };
+
+}
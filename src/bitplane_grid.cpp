@@ -0,0 +1,276 @@
+#include "bitplane_grid.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_half_states = asf::k_max_states / 2;
+    constexpr int k_max_planes = 4;
+    constexpr int k_sum_bits = 6;
+    constexpr int k_word_bits = 64;
+
+    using word = uint64_t;
+
+    // bitwise full adder: adds three one-bit numbers per lane.
+    void full_add(word a, word b, word c, word& sum, word& carry) {
+        auto partial = a ^ b;
+        sum = partial ^ c;
+        carry = (a & b) | (partial & c);
+    }
+
+    // counts, per lane, how many of six one-bit inputs are set, as a three-bit number.
+    std::array<word, 3> count_of_six(const std::array<word, 6>& in) {
+        word s1, c1, s2, c2;
+        full_add(in[0], in[1], in[2], s1, c1);
+        full_add(in[3], in[4], in[5], s2, c2);
+        word ones, carry, twos, fours;
+        ones = s1 ^ s2;
+        carry = s1 & s2;
+        full_add(c1, c2, carry, twos, fours);
+        return { ones, twos, fours };
+    }
+
+    // adds the three-bit per-lane number `count` shifted left by `shift` bits into `acc`.
+    void add_shifted(std::array<word, k_sum_bits>& acc, const std::array<word, 3>& count,
+            int shift) {
+        word carry = 0;
+        for (int i = shift; i < k_sum_bits; ++i) {
+            word addend = (i - shift < 3) ? count[i - shift] : 0;
+            word sum = acc[i] ^ addend ^ carry;
+            carry = (acc[i] & addend) | ((acc[i] ^ addend) & carry);
+            acc[i] = sum;
+        }
+    }
+
+    // decodes three bitplanes into eight masks, mask v being set in the lanes whose
+    // three-bit value is v.
+    std::array<word, 8> decode(word b0, word b1, word b2) {
+        std::array<word, 8> out;
+        for (int v = 0; v < 8; ++v) {
+            out[v] = ((v & 1) ? b0 : ~b0) & ((v & 2) ? b1 : ~b1) & ((v & 4) ? b2 : ~b2);
+        }
+        return out;
+    }
+
+}
+
+asf::bitplane_automaton::bitplane_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        radius_(radius),
+        words_per_row_((2 * radius + 1 + k_word_bits - 1) / k_word_bits + 2),
+        num_planes_(std::max(1, static_cast<int>(std::bit_width(tbl.num_states() - 1u)))),
+        num_states_(tbl.num_states()),
+        extent_(max_radius(seed)) {
+
+    if (num_states_ > k_max_states) {
+        throw std::runtime_error("the bitplane engine supports at most 10 states");
+    }
+    if (extent_ > radius_) {
+        throw std::runtime_error("cell lies outside of bitplane grid");
+    }
+
+    auto size = offset(num_planes_, -radius_ - 1);
+    current_.resize(size, 0);
+    next_.resize(size, 0);
+
+    for (const auto& [hex, state] : seed) {
+        int col = hex.x + radius_;
+        for (int plane = 0; plane < num_planes_; ++plane) {
+            if (state & (1 << plane)) {
+                current_[offset(plane, hex.y) + 1 + col / k_word_bits] |=
+                    word{ 1 } << (col % k_word_bits);
+            }
+        }
+    }
+
+    // for each neighbor sum and bit of the next state, the set of current states for
+    // which that bit is set, so that the step can look the table up with a few bitwise
+    // operations per word.
+    auto rules = flat_rules(tbl);
+    int cols = tbl.stride();
+    state_sets_.resize(1 << k_sum_bits);
+    for (int sum = 0; sum < std::min(cols, 1 << k_sum_bits); ++sum) {
+        for (int state = 0; state < num_states_; ++state) {
+            auto next_state = rules[state * cols + sum];
+            for (int bit = 0; bit < num_planes_; ++bit) {
+                if (next_state & (1 << bit)) {
+                    state_sets_[sum][bit] |= 1 << state;
+                }
+            }
+        }
+    }
+}
+
+size_t asf::bitplane_automaton::offset(int plane, int row) const {
+    int rows = 2 * radius_ + 3;
+    return (static_cast<size_t>(plane) * rows + (row + radius_ + 1)) * words_per_row_;
+}
+
+uint8_t asf::bitplane_automaton::state_at(const hex_coords& hex) const {
+    int col = hex.x + radius_;
+    uint8_t state = 0;
+    for (int plane = 0; plane < num_planes_; ++plane) {
+        auto w = current_[offset(plane, hex.y) + 1 + col / k_word_bits];
+        if ((w >> (col % k_word_bits)) & 1) {
+            state |= 1 << plane;
+        }
+    }
+    return state;
+}
+
+void asf::bitplane_automaton::step() {
+    int extent = std::min(extent_ + 1, radius_);
+
+    for (int row = -extent; row <= extent; ++row) {
+        int first_word = 1 + (std::max(-extent, -extent - row) + radius_) / k_word_bits;
+        int last_word = 1 + (std::min(extent, extent - row) + radius_) / k_word_bits;
+        for (int w = first_word; w <= last_word; ++w) {
+            std::array<word, k_max_planes> center = {};
+            std::array<word, k_sum_bits> sum = {};
+            word any = 0;
+
+            for (int plane = 0; plane < num_planes_; ++plane) {
+                const word* up = &current_[offset(plane, row - 1) + w];
+                const word* mid = &current_[offset(plane, row) + w];
+                const word* down = &current_[offset(plane, row + 1) + w];
+
+                // the neighbors of (x, y) are (x +/- 1, y), (x, y - 1), (x + 1, y - 1),
+                // (x, y + 1) and (x - 1, y + 1); bit i of a row word is column i.
+                std::array<word, 6> in = { {
+                    (mid[0] >> 1) | (mid[1] << 63),
+                    (mid[0] << 1) | (mid[-1] >> 63),
+                    up[0],
+                    (up[0] >> 1) | (up[1] << 63),
+                    down[0],
+                    (down[0] << 1) | (down[-1] >> 63)
+                } };
+                center[plane] = mid[0];
+                any |= mid[0] | in[0] | in[1] | in[2] | in[3] | in[4] | in[5];
+
+                auto count = count_of_six(in);
+                add_shifted(sum, count, plane);
+            }
+
+            if (any == 0) {
+                for (int plane = 0; plane < num_planes_; ++plane) {
+                    next_[offset(plane, row) + w] = 0;
+                }
+                continue;
+            }
+
+            std::array<word, k_max_states> is_state;
+            for (int state = 0; state < num_states_; ++state) {
+                word match = ~word{ 0 };
+                for (int plane = 0; plane < num_planes_; ++plane) {
+                    match &= (state & (1 << plane)) ? center[plane] : ~center[plane];
+                }
+                is_state[state] = match;
+            }
+
+            // the union of the is_state masks of every subset of states, indexed by subset,
+            // with the states split in two halves to keep the tables small.
+            std::array<word, 1 << k_half_states> low_states = {};
+            std::array<word, 1 << k_half_states> high_states = {};
+            for (int subset = 1; subset < (1 << k_half_states); ++subset) {
+                int state = std::countr_zero(static_cast<unsigned>(subset));
+                auto rest = subset & (subset - 1);
+                low_states[subset] = low_states[rest] | is_state[state];
+                high_states[subset] = high_states[rest] |
+                    ((state + k_half_states < num_states_) ? is_state[state + k_half_states] : 0);
+            }
+
+            // decode the neighbor sums and, for each sum that occurs in this word, set the
+            // bits of the next state in the lanes whose current state maps to them.
+            auto low = decode(sum[0], sum[1], sum[2]);
+            auto high = decode(sum[3], sum[4], sum[5]);
+            std::array<word, k_max_planes> out = {};
+            for (int h = 0; h < 8; ++h) {
+                if (high[h] == 0) {
+                    continue;
+                }
+                for (int l = 0; l < 8; ++l) {
+                    auto is_sum = high[h] & low[l];
+                    if (is_sum == 0) {
+                        continue;
+                    }
+                    const auto& sets = state_sets_[8 * h + l];
+                    for (int bit = 0; bit < num_planes_; ++bit) {
+                        auto states = sets[bit];
+                        out[bit] |= is_sum & (
+                            low_states[states & ((1 << k_half_states) - 1)] |
+                            high_states[states >> k_half_states]
+                        );
+                    }
+                }
+            }
+            for (int plane = 0; plane < num_planes_; ++plane) {
+                next_[offset(plane, row) + w] = out[plane];
+            }
+        }
+    }
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+// only the rows within the extent can hold live cells, in every plane; the hash adds up the
+// words it is given, so hashing those rows plane by plane hashes the same as the whole buffer.
+uint64_t asf::bitplane_automaton::hash() const {
+    auto bytes = static_cast<size_t>(2 * extent_ + 1) * words_per_row_ * sizeof(word);
+    uint64_t hash = 0;
+    for (int plane = 0; plane < num_planes_; ++plane) {
+        auto first = offset(plane, -extent_);
+        hash += hash_sparse_bytes(&current_[first], bytes, first * sizeof(word));
+    }
+    return hash;
+}
+
+asf::grid_stats asf::bitplane_automaton::stats() const {
+    grid_stats stats = { 0, 0 };
+    for (int row = -extent_; row <= extent_; ++row) {
+        int first = -1;
+        int last = -1;
+        for (int w = 1; w < words_per_row_ - 1; ++w) {
+            word live = 0;
+            for (int plane = 0; plane < num_planes_; ++plane) {
+                live |= current_[offset(plane, row) + w];
+            }
+            if (live == 0) {
+                continue;
+            }
+            stats.live_count += std::popcount(live);
+            int base = (w - 1) * k_word_bits;
+            first = (first < 0) ? base + std::countr_zero(live) : first;
+            last = base + k_word_bits - 1 - std::countl_zero(live);
+        }
+        if (first >= 0) {
+            int first_col = first - radius_;
+            int last_col = last - radius_;
+            stats.radius = std::max({
+                stats.radius,
+                distance_from_origin({ first_col, row, -first_col - row }),
+                distance_from_origin({ last_col, row, -last_col - row })
+            });
+        }
+    }
+    return stats;
+}
+
+asf::hex_grid asf::bitplane_automaton::to_hex_grid() const {
+    hex_grid grid;
+    for (int row = -extent_; row <= extent_; ++row) {
+        for (int col = std::max(-extent_, -extent_ - row); col <= std::min(extent_, extent_ - row);
+                ++col) {
+            hex_coords hex = { col, row, -col - row };
+            auto state = state_at(hex);
+            if (state > 0) {
+                grid[hex] = state;
+            }
+        }
+    }
+    return grid;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton bit-sliced, with bit b of every cell's state in bitplane b
+    // and each axial row packed into 64-bit words. Supports up to ten states.
+
+    class bitplane_automaton {
+    public:
+        bitplane_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        size_t offset(int plane, int row) const;
+        uint8_t state_at(const hex_coords& hex) const;
+
+        int radius_;
+        int words_per_row_;
+        int num_planes_;
+        int num_states_;
+        int extent_;
+        std::vector<uint64_t> current_;
+        std::vector<uint64_t> next_;
+        std::vector<std::array<uint16_t, 4>> state_sets_;
+    };
+
+}
@@ -0,0 +1,329 @@
+#include "chunked_grid.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    // a chunk together with a halo one cell wide.
+    constexpr int k_pitch = asf::k_chunk_size + 2;
+    constexpr int k_last = asf::k_chunk_size - 1;
+
+    asf::hex_coords chunk_cell(const asf::chunked_grid::chunk_key& key, int col, int row) {
+        int x = key.x * asf::k_chunk_size + col;
+        int y = key.y * asf::k_chunk_size + row;
+        return { x, y, -x - y };
+    }
+
+}
+
+asf::chunked_grid::const_iterator::const_iterator(
+            chunk_map::const_iterator chunk, chunk_map::const_iterator end) :
+        chunk_(chunk),
+        end_(end) {
+    skip_dead_cells();
+}
+
+void asf::chunked_grid::const_iterator::skip_dead_cells() {
+    while (chunk_ != end_ && chunk_->second.cells[index_] == 0) {
+        if (++index_ == k_chunk_cells) {
+            ++chunk_;
+            index_ = 0;
+        }
+    }
+}
+
+asf::chunked_grid::const_iterator::reference asf::chunked_grid::const_iterator::operator*() const {
+    return {
+        chunk_cell(chunk_->first, index_ % k_chunk_size, index_ / k_chunk_size),
+        chunk_->second.cells[index_]
+    };
+}
+
+asf::chunked_grid::const_iterator::pointer asf::chunked_grid::const_iterator::operator->() const {
+    return { **this };
+}
+
+asf::chunked_grid::const_iterator& asf::chunked_grid::const_iterator::operator++() {
+    if (++index_ == k_chunk_cells) {
+        ++chunk_;
+        index_ = 0;
+    }
+    skip_dead_cells();
+    return *this;
+}
+
+asf::chunked_grid::const_iterator asf::chunked_grid::const_iterator::operator++(int) {
+    auto old = *this;
+    ++*this;
+    return old;
+}
+
+bool asf::chunked_grid::const_iterator::operator==(const const_iterator& rhs) const {
+    return chunk_ == rhs.chunk_ && index_ == rhs.index_;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::chunked_grid::chunked_grid(const hex_grid& grid) {
+    for (const auto& [hex, state] : grid) {
+        set(hex, state);
+    }
+}
+
+asf::chunked_grid::chunk_key asf::chunked_grid::key(const hex_coords& hex) {
+    return { hex.x >> k_chunk_bits, hex.y >> k_chunk_bits };
+}
+
+int asf::chunked_grid::index(const hex_coords& hex) {
+    return (hex.y & (k_chunk_size - 1)) * k_chunk_size + (hex.x & (k_chunk_size - 1));
+}
+
+const asf::chunked_grid::chunk* asf::chunked_grid::find_chunk(const chunk_key& key) const {
+    auto it = chunks_.find(key);
+    return (it != chunks_.end()) ? &it->second : nullptr;
+}
+
+bool asf::chunked_grid::empty() const {
+    return live_count_ == 0;
+}
+
+size_t asf::chunked_grid::size() const {
+    return live_count_;
+}
+
+bool asf::chunked_grid::contains(const hex_coords& hex) const {
+    auto c = find_chunk(key(hex));
+    return c && c->cells[index(hex)] > 0;
+}
+
+int asf::chunked_grid::at(const hex_coords& hex) const {
+    auto c = find_chunk(key(hex));
+    if (!c || c->cells[index(hex)] == 0) {
+        throw std::out_of_range("cell is not live");
+    }
+    return c->cells[index(hex)];
+}
+
+void asf::chunked_grid::set(const hex_coords& hex, int state) {
+    auto it = chunks_.find(key(hex));
+    if (it == chunks_.end()) {
+        if (state == 0) {
+            return;
+        }
+        it = chunks_.emplace(key(hex), chunk{ {}, 0 }).first;
+    }
+    auto& c = it->second;
+    auto& cell = c.cells[index(hex)];
+    int change = (state > 0 ? 1 : 0) - (cell > 0 ? 1 : 0);
+    c.live_count += change;
+    live_count_ += change;
+    cell = static_cast<uint8_t>(state);
+    if (c.live_count == 0) {
+        chunks_.erase(it);
+    }
+}
+
+asf::chunked_grid::const_iterator asf::chunked_grid::begin() const {
+    return { chunks_.begin(), chunks_.end() };
+}
+
+asf::chunked_grid::const_iterator asf::chunked_grid::end() const {
+    return { chunks_.end(), chunks_.end() };
+}
+
+uint64_t asf::chunked_grid::hash() const {
+    uint64_t hash = 0;
+    for (const auto& [key, c] : chunks_) {
+        hash += mix_bits(hash_vec2<int>()(key) ^ hash_sparse_bytes(c.cells.data(), c.cells.size()));
+    }
+    return hash;
+}
+
+// chunks whose farthest corner is no farther from the origin than the farthest live cell
+// found so far are skipped; distance is convex, so no cell of a chunk lies beyond its corners.
+asf::grid_stats asf::chunked_grid::stats() const {
+    grid_stats stats = { static_cast<int>(live_count_), 0 };
+    for (const auto& [key, c] : chunks_) {
+        int reach = std::max({
+            distance_from_origin(chunk_cell(key, 0, 0)),
+            distance_from_origin(chunk_cell(key, k_last, 0)),
+            distance_from_origin(chunk_cell(key, 0, k_last)),
+            distance_from_origin(chunk_cell(key, k_last, k_last))
+        });
+        if (reach <= stats.radius) {
+            continue;
+        }
+        for (int i = 0; i < k_chunk_cells; ++i) {
+            if (c.cells[i] > 0) {
+                auto hex = chunk_cell(key, i % k_chunk_size, i / k_chunk_size);
+                stats.radius = std::max(stats.radius, distance_from_origin(hex));
+            }
+        }
+    }
+    return stats;
+}
+
+asf::hex_grid asf::chunked_grid::to_hex_grid() const {
+    hex_grid grid;
+    for (const auto& [hex, state] : *this) {
+        grid[hex] = state;
+    }
+    return grid;
+}
+
+asf::chunked_grid asf::rotate(const chunked_grid& grid, int num_sixths) {
+    chunked_grid out;
+    for (const auto& [hex, state] : grid) {
+        out.set(rotate(hex, num_sixths), state);
+    }
+    return out;
+}
+
+asf::chunked_grid asf::flip_horz(const chunked_grid& grid) {
+    chunked_grid out;
+    for (const auto& [hex, state] : grid) {
+        out.set(flip_horz(hex), state);
+    }
+    return out;
+}
+
+// like the union of two hex grids, the first grid wins where both have a live cell.
+asf::chunked_grid asf::union_(const chunked_grid& g1, const chunked_grid& g2) {
+    auto out = g1;
+    for (const auto& [hex, state] : g2) {
+        if (!out.contains(hex)) {
+            out.set(hex, state);
+        }
+    }
+    return out;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::chunked_automaton::chunked_automaton(
+            const hex_grid& seed, const state_table& tbl, int) :
+        current_(seed),
+        rules_(context_.buffers().rules),
+        step_row_(row_kernel_for(tbl.num_states())),
+        scratch_(context_.buffers().tile),
+        scratch_next_(context_.buffers().next_tile) {
+
+    flat_rules(tbl, rules_);
+    scratch_.assign(k_pitch * k_pitch, 0);
+    scratch_next_.assign(k_pitch * k_pitch, 0);
+}
+
+// copies the chunk with the given key, or zeros if it does not exist, into the scratch
+// buffer along with the edges of its neighbors that its cells' neighbors lie in, and returns
+// true if any of those edge cells is live.
+bool asf::chunked_automaton::load_halo(
+        const chunked_grid::chunk_key& key, const chunked_grid::chunk* center) {
+    std::fill(scratch_.begin(), scratch_.end(), 0);
+    if (center) {
+        for (int row = 0; row < k_chunk_size; ++row) {
+            std::memcpy(&scratch_[(row + 1) * k_pitch + 1],
+                &center->cells[row * k_chunk_size], k_chunk_size);
+        }
+    }
+
+    bool live = false;
+    auto copy_cell = [&](const chunked_grid::chunk* c, int col, int row, int to) {
+        scratch_[to] = c->cells[row * k_chunk_size + col];
+        live |= scratch_[to] > 0;
+    };
+    auto neighbor = [&](int dx, int dy) {
+        return current_.find_chunk({ key.x + dx, key.y + dy });
+    };
+
+    if (auto c = neighbor(0, -1)) {
+        for (int col = 0; col < k_chunk_size; ++col) {
+            copy_cell(c, col, k_last, col + 1);
+        }
+    }
+    if (auto c = neighbor(+1, -1)) {
+        copy_cell(c, 0, k_last, k_pitch - 1);
+    }
+    if (auto c = neighbor(-1, 0)) {
+        for (int row = 0; row < k_chunk_size; ++row) {
+            copy_cell(c, k_last, row, (row + 1) * k_pitch);
+        }
+    }
+    if (auto c = neighbor(+1, 0)) {
+        for (int row = 0; row < k_chunk_size; ++row) {
+            copy_cell(c, 0, row, (row + 1) * k_pitch + k_pitch - 1);
+        }
+    }
+    if (auto c = neighbor(-1, +1)) {
+        copy_cell(c, k_last, 0, (k_pitch - 1) * k_pitch);
+    }
+    if (auto c = neighbor(0, +1)) {
+        for (int col = 0; col < k_chunk_size; ++col) {
+            copy_cell(c, col, 0, (k_pitch - 1) * k_pitch + col + 1);
+        }
+    }
+    return live;
+}
+
+void asf::chunked_automaton::step_chunk(const chunked_grid::chunk_key& key) {
+    auto center = current_.find_chunk(key);
+    // flat_rules keeps rules[0] at 0, so an empty chunk with an empty halo stays empty.
+    if (!load_halo(key, center) && !center) {
+        return;
+    }
+
+    for (int row = 1; row <= k_chunk_size; ++row) {
+        step_row_(scratch_.data(), scratch_next_.data(), k_pitch, rules_.data(),
+            row * k_pitch + 1, row * k_pitch + k_chunk_size);
+    }
+
+    chunked_grid::chunk c;
+    c.live_count = 0;
+    for (int row = 0; row < k_chunk_size; ++row) {
+        const uint8_t* src = &scratch_next_[(row + 1) * k_pitch + 1];
+        std::memcpy(&c.cells[row * k_chunk_size], src, k_chunk_size);
+        c.live_count += static_cast<int>(std::count_if(src, src + k_chunk_size,
+            [](uint8_t state) { return state > 0; }));
+    }
+    if (c.live_count > 0) {
+        next_.live_count_ += c.live_count;
+        next_.chunks_.emplace(key, c);
+    }
+}
+
+void asf::chunked_automaton::step() {
+    next_.chunks_.clear();
+    next_.live_count_ = 0;
+    frontier_.clear();
+    for (const auto& [key, c] : current_.chunks_) {
+        step_chunk(key);
+        for (auto [dx, dy] : k_neighbor_offsets | std::views::take(6)) {
+            chunked_grid::chunk_key neighbor = { key.x + dx, key.y + dy };
+            if (!current_.chunks_.contains(neighbor)) {
+                frontier_.insert(neighbor);
+            }
+        }
+    }
+    for (const auto& key : frontier_) {
+        step_chunk(key);
+    }
+    std::swap(current_, next_);
+}
+
+uint64_t asf::chunked_automaton::hash() const {
+    return current_.hash();
+}
+
+asf::grid_stats asf::chunked_automaton::stats() const {
+    return current_.stats();
+}
+
+const asf::chunked_grid& asf::chunked_automaton::grid() const {
+    return current_;
+}
+
+asf::hex_grid asf::chunked_automaton::to_hex_grid() const {
+    return current_.to_hex_grid();
+}
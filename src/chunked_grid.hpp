@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    constexpr int k_chunk_bits = 5;
+    constexpr int k_chunk_size = 1 << k_chunk_bits;
+    constexpr int k_chunk_cells = k_chunk_size * k_chunk_size;
+
+    // a hex grid stored as a hash map of dense 32x32 chunks in axial coordinates, a chunk
+    // existing only while it holds a live cell. It reads like a hex_grid as far as the
+    // metrics are concerned.
+
+    class chunked_grid {
+    public:
+        using value_type = std::pair<hex_coords, int>;
+        using chunk_key = vec2<int>;
+
+        struct chunk {
+            std::array<uint8_t, k_chunk_cells> cells;
+            int live_count;
+        };
+        using chunk_map = vec2_map<int, chunk>;
+
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = chunked_grid::value_type;
+            using difference_type = std::ptrdiff_t;
+            using reference = value_type;
+
+            struct pointer {
+                value_type value;
+                const value_type* operator->() const { return &value; }
+            };
+
+            const_iterator() = default;
+            const_iterator(chunk_map::const_iterator chunk, chunk_map::const_iterator end);
+
+            reference operator*() const;
+            pointer operator->() const;
+            const_iterator& operator++();
+            const_iterator operator++(int);
+            bool operator==(const const_iterator& rhs) const;
+
+        private:
+            void skip_dead_cells();
+
+            chunk_map::const_iterator chunk_;
+            chunk_map::const_iterator end_;
+            int index_ = 0;
+        };
+
+        chunked_grid() = default;
+        explicit chunked_grid(const hex_grid& grid);
+
+        bool empty() const;
+        size_t size() const;
+        bool contains(const hex_coords& hex) const;
+        int at(const hex_coords& hex) const;
+        void set(const hex_coords& hex, int state);
+        const_iterator begin() const;
+        const_iterator end() const;
+        uint64_t hash() const;
+        grid_stats stats() const;
+        hex_grid to_hex_grid() const;
+
+        static chunk_key key(const hex_coords& hex);
+        static int index(const hex_coords& hex);
+
+    private:
+        friend class chunked_automaton;
+
+        const chunk* find_chunk(const chunk_key& key) const;
+
+        chunk_map chunks_;
+        size_t live_count_ = 0;
+    };
+
+    void display(const chunked_grid& grid);
+    chunked_grid rotate(const chunked_grid& grid, int num_sixths);
+    chunked_grid flip_horz(const chunked_grid& grid);
+    chunked_grid union_(const chunked_grid& g1, const chunked_grid& g2);
+
+    // runs the cellular automaton on a chunked grid, stepping each chunk through a halo one
+    // cell wide and dropping chunks that come out empty. It ignores the radius it is given.
+
+    class chunked_automaton {
+    public:
+        chunked_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const chunked_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        bool load_halo(const chunked_grid::chunk_key& key, const chunked_grid::chunk* center);
+        void step_chunk(const chunked_grid::chunk_key& key);
+
+        simulation_context context_;
+        chunked_grid current_;
+        chunked_grid next_;
+        std::vector<uint8_t>& rules_;
+        row_kernel step_row_;
+        std::vector<uint8_t>& scratch_;
+        std::vector<uint8_t>& scratch_next_;
+        vec2_set<int> frontier_;
+    };
+
+}
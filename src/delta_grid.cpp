@@ -0,0 +1,120 @@
+#include "delta_grid.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    uint64_t cell_hash(int index, uint8_t state) {
+        return asf::mix_bits(static_cast<uint64_t>(index) ^ asf::mix_bits(state));
+    }
+
+}
+
+// the neighbor sums are kept in the second grid of the pooled dense buffers, which is
+// otherwise unused here.
+asf::delta_automaton::delta_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        state_(context_.buffers().current),
+        sums_(context_.buffers().next),
+        rules_(context_.buffers().rules),
+        rules_stride_(tbl.stride()),
+        queued_(context_.buffers().flags),
+        queue_(context_.buffers().queue),
+        updates_(context_.buffers().updates),
+        ring_counts_(context_.buffers().counts),
+        hash_(0),
+        live_count_(0) {
+
+    state_.reset(radius);
+    sums_.reset(radius);
+    flat_rules(tbl, rules_);
+    queued_.assign(static_cast<size_t>(state_.stride()) * state_.stride(), 0);
+    queue_.clear();
+    updates_.clear();
+    ring_counts_.clear();
+    for (const auto& [hex, state] : seed) {
+        if (distance_from_origin(hex) > radius) {
+            throw std::runtime_error("cell lies outside of dense grid");
+        }
+        set(state_.index(hex), static_cast<uint8_t>(state));
+    }
+}
+
+void asf::delta_automaton::enqueue(int index) {
+    if (!queued_[index]) {
+        queued_[index] = 1;
+        queue_.push_back(index);
+    }
+}
+
+// changes the state of a cell, passing the change on to its neighbors' sums and queueing
+// it and them, and keeps the hash and the number of live cells at each distance from the
+// origin up to date.
+void asf::delta_automaton::set(int index, uint8_t state) {
+    uint8_t* cells = state_.data();
+    uint8_t* sums = sums_.data();
+    auto old_state = cells[index];
+    int delta = state - old_state;
+    cells[index] = state;
+
+    enqueue(index);
+    for (auto d : neighbor_deltas<6>(state_.stride())) {
+        sums[index + d] = static_cast<uint8_t>(sums[index + d] + delta);
+        enqueue(index + d);
+    }
+
+    auto ring = distance_from_origin(state_.coords(index));
+    if (ring >= static_cast<int>(ring_counts_.size())) {
+        ring_counts_.resize(ring + 1, 0);
+    }
+    if (old_state > 0) {
+        hash_ -= cell_hash(index, old_state);
+        --ring_counts_[ring];
+        --live_count_;
+    }
+    if (state > 0) {
+        hash_ += cell_hash(index, state);
+        ++ring_counts_[ring];
+        ++live_count_;
+    }
+}
+
+void asf::delta_automaton::step() {
+    const uint8_t* cells = state_.data();
+    const uint8_t* sums = sums_.data();
+    updates_.clear();
+    for (auto index : queue_) {
+        queued_[index] = 0;
+        auto next_state = rules_[cells[index] * rules_stride_ + sums[index]];
+        if (next_state != cells[index]) {
+            updates_.emplace_back(index, next_state);
+        }
+    }
+
+    queue_.clear();
+    for (auto [index, next_state] : updates_) {
+        set(index, next_state);
+    }
+}
+
+uint64_t asf::delta_automaton::hash() const {
+    return hash_;
+}
+
+asf::grid_stats asf::delta_automaton::stats() const {
+    int radius = static_cast<int>(ring_counts_.size()) - 1;
+    while (radius > 0 && ring_counts_[radius] == 0) {
+        --radius;
+    }
+    return { live_count_, std::max(radius, 0) };
+}
+
+const asf::dense_grid& asf::delta_automaton::grid() const {
+    return state_;
+}
+
+asf::hex_grid asf::delta_automaton::to_hex_grid() const {
+    return state_.to_hex_grid();
+}
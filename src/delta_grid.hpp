@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton event by event: it keeps every cell's neighbor sum, and
+    // each step only visits the cells that changed in the previous one and their neighbors.
+
+    class delta_automaton {
+    public:
+        delta_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const dense_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        void enqueue(int index);
+        void set(int index, uint8_t state);
+
+        simulation_context context_;
+        dense_grid& state_;
+        dense_grid& sums_;
+        std::vector<uint8_t>& rules_;
+        int rules_stride_;
+        std::vector<uint8_t>& queued_;
+        std::vector<int>& queue_;
+        std::vector<std::pair<int, uint8_t>>& updates_;
+        std::vector<int>& ring_counts_;
+        uint64_t hash_;
+        int live_count_;
+    };
+
+}
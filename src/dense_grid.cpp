@@ -0,0 +1,316 @@
+#include "dense_grid.hpp"
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_guard = 2;
+    constexpr int k_min_parallel_live_cells = 1 << 15;
+    constexpr int k_min_rows_per_band = 8;
+    constexpr int k_bands_per_thread = 4;
+
+    // the buffers of the runs that have finished on this thread, for the next runs to reuse.
+    thread_local std::vector<std::unique_ptr<asf::dense_buffers>> t_spare_buffers;
+
+    // calls fn(row, first_col, last_col) for each row of the hexagon of the given
+    // radius, in axial coordinates.
+    template<typename F>
+    void for_each_hex_row(int radius, F fn) {
+        for (int row = -radius; row <= radius; ++row) {
+            fn(row, std::max(-radius, -radius - row), std::min(radius, radius - row));
+        }
+    }
+
+    template<int N>
+    void step_row(const uint8_t* src, uint8_t* dst, int stride, const uint8_t* rules,
+            int first, int last) {
+        constexpr int rules_stride = asf::num_sums(N);
+        // the deltas are unpacked into locals since stores through dst could otherwise
+        // alias the array and force the deltas to be reloaded for every cell.
+        const auto [d0, d1, d2, d3, d4, d5] = asf::neighbor_deltas<6>(stride);
+        for (int i = first; i <= last; ++i) {
+            int sum = src[i + d0] + src[i + d1] + src[i + d2] +
+                src[i + d3] + src[i + d4] + src[i + d5];
+            dst[i] = rules[src[i] * rules_stride + sum];
+        }
+    }
+
+    // the kernel for the neighborhoods that include the diagonal neighbors. The row is done
+    // in blocks, a vectorizable loop computing the rule offsets and a second looking them up.
+    template<int N, asf::neighborhood_type H>
+    void step_row_diagonal(const uint8_t* src, uint8_t* dst, int stride, const uint8_t* rules,
+            int first, int last) {
+        constexpr int rules_stride = asf::num_sums(N, H);
+        static_assert(N * rules_stride <= 1 << 16);
+        constexpr int block = 256;
+        const auto [d0, d1, d2, d3, d4, d5, d6, d7, d8, d9, d10, d11] =
+            asf::neighbor_deltas<12>(stride);
+        uint16_t offsets[block];
+        for (int start = first; start <= last; start += block) {
+            int count = std::min(block, last - start + 1);
+            const uint8_t* s = src + start;
+            for (int j = 0; j < count; ++j) {
+                uint16_t direct_sum = s[j + d0] + s[j + d1] + s[j + d2] +
+                    s[j + d3] + s[j + d4] + s[j + d5];
+                uint16_t diagonal_sum = s[j + d6] + s[j + d7] + s[j + d8] +
+                    s[j + d9] + s[j + d10] + s[j + d11];
+                uint16_t column = (H == asf::neighborhood_type::split) ?
+                    direct_sum * asf::num_sums(N) + diagonal_sum : direct_sum + diagonal_sum;
+                offsets[j] = static_cast<uint16_t>(s[j] * rules_stride + column);
+            }
+            for (int j = 0; j < count; ++j) {
+                dst[start + j] = rules[offsets[j]];
+            }
+        }
+    }
+
+}
+
+asf::dense_grid::dense_grid(int radius) {
+    reset(radius);
+}
+
+asf::dense_grid::dense_grid(const hex_grid& grid, int radius) {
+    reset(grid, radius);
+}
+
+void asf::dense_grid::reset(int radius) {
+    radius_ = radius;
+    stride_ = 2 * (radius + k_guard) + 1;
+    cells_.assign(static_cast<size_t>(stride_) * stride_, 0);
+}
+
+void asf::dense_grid::reset(const hex_grid& grid, int radius) {
+    reset(radius);
+    for (const auto& [hex, state] : grid) {
+        if (distance_from_origin(hex) > radius_) {
+            throw std::runtime_error("cell lies outside of dense grid");
+        }
+        set(hex, static_cast<uint8_t>(state));
+    }
+}
+
+int asf::dense_grid::radius() const {
+    return radius_;
+}
+
+int asf::dense_grid::stride() const {
+    return stride_;
+}
+
+int asf::dense_grid::index(const hex_coords& hex) const {
+    return (hex.y + radius_ + k_guard) * stride_ + (hex.x + radius_ + k_guard);
+}
+
+asf::hex_coords asf::dense_grid::coords(int index) const {
+    int x = index % stride_ - radius_ - k_guard;
+    int y = index / stride_ - radius_ - k_guard;
+    return { x, y, -x - y };
+}
+
+uint8_t asf::dense_grid::at(const hex_coords& hex) const {
+    return cells_[index(hex)];
+}
+
+void asf::dense_grid::set(const hex_coords& hex, uint8_t state) {
+    cells_[index(hex)] = state;
+}
+
+void asf::dense_grid::clear() {
+    std::fill(cells_.begin(), cells_.end(), 0);
+}
+
+// a hash of the cells within the hexagon of radius `extent`, where all of the live ones
+// are. It only reads the rows of the hexagon, but hashes the same as the whole buffer would.
+uint64_t asf::dense_grid::hash(int extent) const {
+    extent = std::min(extent, radius_);
+    size_t first = index({ 0, -extent, extent });
+    size_t last = index({ 0, extent, -extent });
+    first -= first % sizeof(uint64_t);
+    return hash_sparse_bytes(&cells_[first], last + 1 - first, first);
+}
+
+// the stats of the live cells within the hexagon of radius `extent`. Along a row, distance
+// from the origin only ever decreases then increases, so the farthest live cell of each row
+// is its first or its last one.
+asf::grid_stats asf::dense_grid::stats(int extent) const {
+    grid_stats stats = { 0, 0 };
+    for_each_hex_row(std::min(extent, radius_),
+        [&](int row, int first_col, int last_col) {
+            const uint8_t* cells = &cells_[index({ first_col, row, -first_col - row })];
+            int first = -1;
+            int last = -1;
+            for (int i = 0; i <= last_col - first_col; ++i) {
+                if (cells[i] != 0) {
+                    ++stats.live_count;
+                    first = (first < 0) ? i : first;
+                    last = i;
+                }
+            }
+            if (first >= 0) {
+                int col1 = first_col + first;
+                int col2 = first_col + last;
+                stats.radius = std::max({
+                    stats.radius,
+                    distance_from_origin({ col1, row, -col1 - row }),
+                    distance_from_origin({ col2, row, -col2 - row })
+                });
+            }
+        }
+    );
+    return stats;
+}
+
+uint8_t* asf::dense_grid::data() {
+    return cells_.data();
+}
+
+const uint8_t* asf::dense_grid::data() const {
+    return cells_.data();
+}
+
+asf::hex_grid asf::dense_grid::to_hex_grid() const {
+    hex_grid grid;
+    for_each_hex_row(radius_,
+        [&](int row, int first_col, int last_col) {
+            for (int col = first_col; col <= last_col; ++col) {
+                hex_coords hex = { col, row, -col - row };
+                auto state = at(hex);
+                if (state > 0) {
+                    grid[hex] = state;
+                }
+            }
+        }
+    );
+    return grid;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::simulation_context::simulation_context() {
+    if (t_spare_buffers.empty()) {
+        buffers_ = std::make_unique<dense_buffers>();
+    } else {
+        buffers_ = std::move(t_spare_buffers.back());
+        t_spare_buffers.pop_back();
+    }
+}
+
+asf::simulation_context::~simulation_context() {
+    t_spare_buffers.push_back(std::move(buffers_));
+}
+
+asf::dense_buffers& asf::simulation_context::buffers() {
+    return *buffers_;
+}
+
+asf::row_kernel asf::row_kernel_for(int num_states, neighborhood_type neighborhood) {
+    return with_num_states(num_states,
+        [neighborhood](auto n) -> row_kernel {
+            switch (neighborhood) {
+                case neighborhood_type::extended:
+                    return step_row_diagonal<n(), neighborhood_type::extended>;
+                case neighborhood_type::split:
+                    return step_row_diagonal<n(), neighborhood_type::split>;
+                default:
+                    return step_row<n()>;
+            }
+        }
+    );
+}
+
+asf::dense_automaton::dense_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        current_(context_.buffers().current),
+        next_(context_.buffers().next),
+        rules_(context_.buffers().rules),
+        step_row_(row_kernel_for(tbl.num_states(), tbl.neighborhood())),
+        reach_(reach(tbl.neighborhood())),
+        extent_(max_radius(seed)),
+        parallel_(false),
+        live_count_(static_cast<int>(seed.size())),
+        band_live_counts_(context_.buffers().counts) {
+
+    current_.reset(seed, radius);
+    next_.reset(radius);
+    flat_rules(tbl, rules_);
+
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    band_live_counts_.assign(threads * k_bands_per_thread, 0);
+}
+
+void asf::dense_automaton::set_parallel(bool enabled) {
+    parallel_ = enabled;
+}
+
+// steps rows first_row through last_row of the hexagon of radius `extent` and, with
+// parallel steps enabled, returns how many of their cells are live afterwards.
+int asf::dense_automaton::sweep_rows(int first_row, int last_row, int extent) {
+    int stride = current_.stride();
+    const uint8_t* src = current_.data();
+    uint8_t* dst = next_.data();
+    const uint8_t* rules = rules_.data();
+
+    int live = 0;
+    for (int row = first_row; row <= last_row; ++row) {
+        int first_col = std::max(-extent, -extent - row);
+        int last_col = std::min(extent, extent - row);
+        int first = current_.index({ first_col, row, -first_col - row });
+        int last = first + (last_col - first_col);
+        step_row_(src, dst, stride, rules, first, last);
+        if (parallel_) {
+            live += static_cast<int>(last - first + 1 - std::count(dst + first, dst + last + 1, 0));
+        }
+    }
+    return live;
+}
+
+void asf::dense_automaton::step() {
+    // nothing can move faster than one cell per step, or two with diagonal neighbors, so
+    // only the hexagon that much larger than the current extent needs to be swept;
+    // everything beyond it is still zero in both buffers.
+    int extent = std::min(extent_ + reach_, current_.radius());
+    int rows = 2 * extent + 1;
+    int num_bands = std::min(static_cast<int>(band_live_counts_.size()), rows / k_min_rows_per_band);
+
+    if (!parallel_ || live_count_ < k_min_parallel_live_cells || num_bands < 2) {
+        live_count_ = sweep_rows(-extent, extent, extent);
+    } else {
+        // the bands only write to their own rows of the next grid, so they need no
+        // synchronization beyond waiting for all of them at the end of the step.
+        auto bands = band_live_counts_.begin();
+        std::iota(bands, bands + num_bands, 0);
+        std::for_each(std::execution::par, bands, bands + num_bands,
+            [&](int& band) {
+                int first_row = -extent + rows * band / num_bands;
+                int last_row = -extent + rows * (band + 1) / num_bands - 1;
+                band = sweep_rows(first_row, last_row, extent);
+            }
+        );
+        live_count_ = std::accumulate(bands, bands + num_bands, 0);
+    }
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+uint64_t asf::dense_automaton::hash() const {
+    return current_.hash(extent_);
+}
+
+asf::grid_stats asf::dense_automaton::stats() const {
+    return current_.stats(extent_);
+}
+
+const asf::dense_grid& asf::dense_automaton::grid() const {
+    return current_;
+}
+
+asf::hex_grid asf::dense_automaton::to_hex_grid() const {
+    return current_.to_hex_grid();
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // the axial offsets (dx, dy) of the six neighbors of a cell, in the order of
+    // asf::neighbors, followed by the offsets of its six diagonal neighbors.
+    constexpr std::array<std::array<int, 2>, 12> k_neighbor_offsets = { {
+        {+1, 0}, {+1, -1}, {0, -1}, {-1, 0}, {-1, +1}, {0, +1},
+        {+2, -1}, {+1, -2}, {-1, -1}, {-2, +1}, {-1, +2}, {+1, +1}
+    } };
+
+    // the differences between the index of a cell and the indices of its first N neighbors
+    // in k_neighbor_offsets, in a grid laid out in axial rows of the given stride: N = 6 for
+    // the direct neighbors and N = 12 for the direct and diagonal ones.
+    template<int N>
+    constexpr std::array<int, N> neighbor_deltas(int stride) {
+        static_assert(N == 6 || N == 12);
+        std::array<int, N> deltas = {};
+        for (int i = 0; i < N; ++i) {
+            deltas[i] = k_neighbor_offsets[i][0] + k_neighbor_offsets[i][1] * stride;
+        }
+        return deltas;
+    }
+
+    // a hexagon of the given radius stored as a contiguous array in axial coordinates,
+    // i.e. row = hex.y and column = hex.x, with a ring of dead guard cells two deep.
+
+    class dense_grid {
+    public:
+        explicit dense_grid(int radius = 0);
+        dense_grid(const hex_grid& grid, int radius);
+
+        // makes this an empty grid, or a copy of `grid`, of the given radius, reusing the
+        // memory it already holds when it is large enough.
+        void reset(int radius);
+        void reset(const hex_grid& grid, int radius);
+
+        int radius() const;
+        int stride() const;
+        int index(const hex_coords& hex) const;
+        hex_coords coords(int index) const;
+        uint8_t at(const hex_coords& hex) const;
+        void set(const hex_coords& hex, uint8_t state);
+        void clear();
+        uint64_t hash(int extent) const;
+        grid_stats stats(int extent) const;
+
+        uint8_t* data();
+        const uint8_t* data() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        int radius_;
+        int stride_;
+        std::vector<uint8_t> cells_;
+    };
+
+    // the pair of grids and the flattened rules that a dense run steps with, and the
+    // scratch that the engines keep beside them: the live counts of the bands of a parallel
+    // step, the delta engine's queue and ring counts, and the tile buffers of the tiled and
+    // chunked engines.
+    struct dense_buffers {
+        dense_grid current;
+        dense_grid next;
+        std::vector<uint8_t> rules;
+        std::vector<int> counts;
+        std::vector<uint8_t> flags;
+        std::vector<int> queue;
+        std::vector<std::pair<int, uint8_t>> updates;
+        std::vector<uint8_t> tile;
+        std::vector<uint8_t> next_tile;
+    };
+
+    // lends the calling thread's spare dense_buffers to a run for as long as the context
+    // lives, or new ones if the thread has none to spare. Used by the dense, simd, tiled,
+    // chunked and delta engines.
+
+    class simulation_context {
+    public:
+        simulation_context();
+        ~simulation_context();
+        simulation_context(const simulation_context&) = delete;
+        simulation_context& operator=(const simulation_context&) = delete;
+
+        dense_buffers& buffers();
+
+    private:
+        std::unique_ptr<dense_buffers> buffers_;
+    };
+
+    // applies the flattened rules of an automaton with a fixed number of states and a
+    // fixed neighborhood to the cells first through last of a buffer laid out in axial rows
+    // of the given stride, reading from src and writing to dst.
+    using row_kernel = void (*)(const uint8_t* src, uint8_t* dst, int stride,
+        const uint8_t* rules, int first, int last);
+
+    row_kernel row_kernel_for(int num_states,
+        neighborhood_type neighborhood = neighborhood_type::direct);
+
+    // runs the cellular automaton on a pair of dense grids large enough to hold
+    // everything the seed can grow into, i.e. its light cone. With parallel steps enabled,
+    // a step over enough live cells is split into bands of rows swept in parallel.
+
+    class dense_automaton {
+    public:
+        dense_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void set_parallel(bool enabled);
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const dense_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        int sweep_rows(int first_row, int last_row, int extent);
+
+        simulation_context context_;
+        dense_grid& current_;
+        dense_grid& next_;
+        std::vector<uint8_t>& rules_;
+        row_kernel step_row_;
+        int reach_;
+        int extent_;
+        bool parallel_;
+        int live_count_;
+        std::vector<int>& band_live_counts_;
+    };
+
+}
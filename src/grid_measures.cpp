@@ -0,0 +1,259 @@
+#include "grid_measures.hpp"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_guard = 2;
+
+    // the neighbors of a cell that come before it in the sweep, as indices into
+    // k_neighbor_offsets, in order around the cell, the direct ones at even positions.
+    constexpr std::array<int, 6> k_earlier = { 2, 8, 3, 9, 4, 10 };
+
+    thread_local asf::component_labeler t_labeler;
+
+    // how close a cell of the tri region lies to one of the two edges of the region that run
+    // out from the origin, from 1 on an edge down to 0 halfway between them.
+    double edge_proximity(int x, int y) {
+        int row = -y;
+        if (row <= 0) {
+            return 1.0;
+        }
+        double max_dist = static_cast<double>(row) / 2.0;
+        double dist = static_cast<double>(std::min(std::abs(x), std::abs(x - row)));
+        auto relative_edge_dist = dist / max_dist;
+        return 1.0 - std::pow(relative_edge_dist, 2.0);
+    }
+
+    // the number of cells of the full snowflake that a cell of the wedge x >= 0, z >= x
+    // stands for: the center is alone, cells on the wedge's two edges have six images, and
+    // all other cells twelve.
+    int multiplicity(int x, int y) {
+        if (y == 0) {
+            return 1;
+        }
+        return (x == 0 || x == -x - y) ? 6 : 12;
+    }
+
+}
+
+void asf::component_labeler::forest::reset(size_t size) {
+    if (parent_.size() < size) {
+        parent_.resize(size);
+        size_.resize(size);
+    }
+    components_ = 0;
+    largest_ = 0;
+}
+
+// only the entries of the cells added since the last reset mean anything, so resetting
+// never needs to clear the forest.
+void asf::component_labeler::forest::add(int i) {
+    parent_[i] = i;
+    size_[i] = 1;
+    ++components_;
+    largest_ = std::max(largest_, 1);
+}
+
+// adds cell i to the set of an earlier cell rather than as a set of its own.
+void asf::component_labeler::forest::attach(int i, int to) {
+    int root = find(to);
+    parent_[i] = root;
+    largest_ = std::max(largest_, ++size_[root]);
+}
+
+int asf::component_labeler::forest::find(int i) {
+    while (parent_[i] != i) {
+        parent_[i] = parent_[parent_[i]];
+        i = parent_[i];
+    }
+    return i;
+}
+
+void asf::component_labeler::forest::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a == b) {
+        return;
+    }
+    if (size_[a] < size_[b]) {
+        std::swap(a, b);
+    }
+    parent_[b] = a;
+    size_[a] += size_[b];
+    --components_;
+    largest_ = std::max(largest_, size_[a]);
+}
+
+int asf::component_labeler::forest::components() const {
+    return components_;
+}
+
+int asf::component_labeler::forest::largest() const {
+    return largest_;
+}
+
+void asf::component_labeler::reset(const dense_grid& grid) {
+    cells_ = grid.data();
+    deltas_ = neighbor_deltas<12>(grid.stride());
+    auto size = static_cast<size_t>(grid.stride()) * grid.stride();
+    direct_.reset(size);
+    diagonal_.reset(size);
+}
+
+// earlier neighbors that neighbor each other already share a set, so the cell joins one of
+// them and is only united with the ones that follow a gap in the mask.
+void asf::component_labeler::add(int index) {
+    int live = 0;
+    for (int j = 0; j < 6; ++j) {
+        live |= (cells_[index + deltas_[k_earlier[j]]] > 0 ? 1 : 0) << j;
+    }
+    auto earlier = [&](int j) {
+        return index + deltas_[k_earlier[j]];
+    };
+
+    if (live & 0b000100) {
+        direct_.attach(index, earlier(2));
+    } else if (live & 0b000001) {
+        direct_.attach(index, earlier(0));
+        if (live & 0b010000) {
+            direct_.unite(index, earlier(4));
+        }
+    } else if (live & 0b010000) {
+        direct_.attach(index, earlier(4));
+    } else {
+        direct_.add(index);
+    }
+
+    if (live == 0) {
+        diagonal_.add(index);
+        return;
+    }
+    int previous = std::countr_zero(static_cast<unsigned>(live));
+    diagonal_.attach(index, earlier(previous));
+    for (int j = previous + 1; j < 6; ++j) {
+        if (live & (1 << j)) {
+            if (j - previous > 2) {
+                diagonal_.unite(index, earlier(j));
+            }
+            previous = j;
+        }
+    }
+}
+
+asf::grid_connectivity asf::component_labeler::connectivity() const {
+    return {
+        direct_.components(),
+        diagonal_.components(),
+        direct_.largest(),
+        diagonal_.largest()
+    };
+}
+
+asf::grid_connectivity asf::measure_connectivity(const dense_grid& grid, int extent) {
+    int stride = grid.stride();
+    int origin = grid.radius() + k_guard;
+    const uint8_t* cells = grid.data();
+    t_labeler.reset(grid);
+    for (int x = -extent; x <= extent; ++x) {
+        int first_y = std::max(-extent, -extent - x);
+        int last_y = std::min(extent, extent - x);
+        int i = (first_y + origin) * stride + (x + origin);
+        for (int y = first_y; y <= last_y; ++y, i += stride) {
+            if (cells[i] > 0) {
+                t_labeler.add(i);
+            }
+        }
+    }
+    return t_labeler.connectivity();
+}
+
+asf::grid_measures asf::measure_grid(const dense_grid& grid, int extent) {
+    grid_measures measures = {};
+    int stride = grid.stride();
+    int origin = grid.radius() + k_guard;
+    const uint8_t* cells = grid.data();
+    auto deltas = neighbor_deltas<6>(stride);
+    t_labeler.reset(grid);
+
+    int reach = extent + 1;
+    for (int x = -reach; x <= reach; ++x) {
+        int first_y = std::max(-reach, -reach - x);
+        int last_y = std::min(reach, reach - x);
+        int i = (first_y + origin) * stride + (x + origin);
+        for (int y = first_y; y <= last_y; ++y, i += stride) {
+            if (cells[i] == 0) {
+                int mask = 0;
+                for (int k = 0; k < 6; ++k) {
+                    mask |= (cells[i + deltas[k]] > 0 ? 1 : 0) << k;
+                }
+                if (mask != 0) {
+                    ++measures.periphery_count;
+                    measures.craggy_count += k_craggy_masks[mask] ? 1 : 0;
+                }
+                continue;
+            }
+
+            ++measures.live_count;
+            int dist = std::max({ std::abs(x), std::abs(y), std::abs(x + y) });
+            measures.radius = std::max(measures.radius, dist);
+            if (x >= 0 && y <= 0 && x + y <= 0) {
+                measures.spike_sum += edge_proximity(x, y);
+                ++measures.spike_count;
+            }
+            t_labeler.add(i);
+        }
+    }
+
+    measures.connectivity = t_labeler.connectivity();
+    return measures;
+}
+
+// the wedge occupies rows y = 0 down to y = -reach and, within row y, the columns x = 0 up
+// to x = -y / 2; every cell of row y lies at distance -y from the origin.
+asf::grid_measures asf::measure_symmetric_grid(const dense_grid& grid, int extent) {
+    grid_measures measures = {};
+    int stride = grid.stride();
+    int origin = grid.radius() + k_guard;
+    const uint8_t* cells = grid.data();
+    auto deltas = neighbor_deltas<6>(stride);
+
+    int reach = extent + 1;
+    for (int y = 0; y >= -reach; --y) {
+        const uint8_t* row = cells + (y + origin) * stride + origin;
+        for (int x = 0; x <= -y / 2; ++x) {
+            const uint8_t* cell = row + x;
+            int weight = multiplicity(x, y);
+            if (*cell == 0) {
+                int mask = 0;
+                for (int k = 0; k < 6; ++k) {
+                    mask |= (cell[deltas[k]] > 0 ? 1 : 0) << k;
+                }
+                if (mask != 0) {
+                    measures.periphery_count += weight;
+                    measures.craggy_count += k_craggy_masks[mask] ? weight : 0;
+                }
+                continue;
+            }
+            measures.live_count += weight;
+            measures.radius = std::max(measures.radius, -y);
+        }
+    }
+
+    for (int x = 0; x <= extent; ++x) {
+        int i = (-extent + origin) * stride + (x + origin);
+        for (int y = -extent; y <= -x; ++y, i += stride) {
+            if (cells[i] > 0) {
+                measures.spike_sum += edge_proximity(x, y);
+                ++measures.spike_count;
+            }
+        }
+    }
+
+    return measures;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "dense_grid.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // whether a dead cell counts as craggy, indexed by the mask of its live direct neighbors:
+    // three or more of them, forming a single run around the ring.
+    constexpr std::array<bool, 64> k_craggy_masks = [] {
+        constexpr unsigned full_ring = 0x3f;
+        std::array<bool, 64> craggy = {};
+        for (unsigned mask = 0; mask <= full_ring; ++mask) {
+            unsigned previous = ((mask << 1) | (mask >> 5)) & full_ring;
+            int runs = std::popcount(mask & ~previous);
+            craggy[mask] = std::popcount(mask) >= 3 && (runs == 1 || mask == full_ring);
+        }
+        return craggy;
+    }();
+
+    // the connected components of the live cells of a grid when only direct neighbors are
+    // adjacent, and when diagonal neighbors are too: how many there are and how many cells
+    // the largest one has.
+    struct grid_connectivity {
+        int direct_components;
+        int diagonal_components;
+        int largest_direct_component;
+        int largest_diagonal_component;
+    };
+
+    // finds the components of the live cells of a dense grid as they are swept column by
+    // column, each column from top to bottom, with one union-find forest for direct
+    // neighbors and one for direct and diagonal neighbors.
+
+    class component_labeler {
+    public:
+        void reset(const dense_grid& grid);
+        void add(int index);
+        grid_connectivity connectivity() const;
+
+    private:
+        class forest {
+        public:
+            void reset(size_t size);
+            void add(int i);
+            void attach(int i, int to);
+            int find(int i);
+            void unite(int a, int b);
+            int components() const;
+            int largest() const;
+
+        private:
+            std::vector<int> parent_;
+            std::vector<int> size_;
+            int components_;
+            int largest_;
+        };
+
+        const uint8_t* cells_;
+        std::array<int, 12> deltas_;
+        forest direct_;
+        forest diagonal_;
+    };
+
+    // labels the live cells of a dense grid, all of which lie within the hexagon of radius
+    // `extent`, itself no larger than the grid.
+    grid_connectivity measure_connectivity(const dense_grid& grid, int extent);
+
+    // the counts and sums that a snowflake's score is computed from.
+    struct grid_measures {
+        int live_count;
+        int radius;
+        grid_connectivity connectivity;
+        // the dead cells with a live neighbor, and those of them whose three or more live
+        // neighbors form one unbroken arc.
+        int periphery_count;
+        int craggy_count;
+        // the edge proximities of the live cells in the tri region, summed in the order of
+        // asf::tri_region, and the number of those cells.
+        double spike_sum;
+        int spike_count;
+    };
+
+    // gathers all of the measures in a single sweep over the hexagon of radius `extent` + 1
+    // of a dense grid, where `extent` bounds its live cells. The spike sum adds up the same
+    // terms in the same order as scoring a hex grid does.
+    grid_measures measure_grid(const dense_grid& grid, int extent);
+
+    // gathers the same measures except the components for a grid with full sixfold
+    // rotational and mirror symmetry from its 30 degree wedge x >= 0, z >= x, each wedge cell
+    // counted once per image. The spike sum is still taken over the whole tri region.
+    grid_measures measure_symmetric_grid(const dense_grid& grid, int extent);
+
+}
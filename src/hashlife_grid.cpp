@@ -0,0 +1,282 @@
+#include "hashlife_grid.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_min_root_level = 3;
+    constexpr int k_max_log_steps = 6;
+    constexpr size_t k_nodes_per_cell = 16;
+    constexpr size_t k_min_nodes = size_t{ 1 } << 16;
+    constexpr size_t k_max_nodes = size_t{ 1 } << 20;
+
+    // the children of a node, in the order nw, ne, sw, se.
+    constexpr int k_nw = 0;
+    constexpr int k_ne = 1;
+    constexpr int k_sw = 2;
+    constexpr int k_se = 3;
+
+    // how many nodes the tables of a run that can reach the given radius may grow to before
+    // they are cleared. Every worker of a generation runs its own automaton, so the cap is
+    // kept to a small multiple of the cells the run can reach.
+    size_t node_budget(int radius) {
+        auto cells = 3 * static_cast<size_t>(radius) * (radius + 1) + 1;
+        return std::clamp(k_nodes_per_cell * cells, k_min_nodes, k_max_nodes);
+    }
+
+}
+
+size_t asf::hashlife_automaton::quad_hash::operator()(const quad& q) const {
+    auto high = (uint64_t{ q[0] } << 32) | q[1];
+    auto low = (uint64_t{ q[2] } << 32) | q[3];
+    return static_cast<size_t>(mix_bits(high ^ mix_bits(low)));
+}
+
+asf::hashlife_automaton::hashlife_automaton(const hex_grid& seed, const state_table& tbl) :
+        rules_(flat_rules(tbl)),
+        rules_stride_(tbl.stride()),
+        num_leaves_(tbl.num_states()),
+        radius_(max_radius(seed)) {
+
+    // the leaves are the single cells, one per state, so that the id of a leaf is its state.
+    for (int state = 0; state < num_leaves_; ++state) {
+        nodes_.push_back({ 0, { 0, 0, 0, 0 }, state > 0 ? 1u : 0u });
+    }
+    empty_.push_back(0);
+
+    int extent = 0;
+    for (const auto& [hex, state] : seed) {
+        extent = std::max({ extent, std::abs(hex.x), std::abs(hex.y) });
+    }
+    int level = k_min_root_level;
+    while ((1 << (level - 1)) <= extent) {
+        ++level;
+    }
+
+    root_ = empty(level);
+    int half = 1 << (level - 1);
+    for (const auto& [hex, state] : seed) {
+        root_ = set_cell(root_, hex.x + half, hex.y + half, static_cast<uint8_t>(state));
+    }
+}
+
+asf::hashlife_automaton::node_id asf::hashlife_automaton::join(
+        node_id nw, node_id ne, node_id sw, node_id se) {
+    quad children = { nw, ne, sw, se };
+    auto it = interned_.find(children);
+    if (it != interned_.end()) {
+        return it->second;
+    }
+    node n = {
+        nodes_[nw].level + 1,
+        children,
+        nodes_[nw].population + nodes_[ne].population +
+            nodes_[sw].population + nodes_[se].population
+    };
+    auto id = static_cast<node_id>(nodes_.size());
+    nodes_.push_back(n);
+    interned_.emplace(children, id);
+    return id;
+}
+
+asf::hashlife_automaton::node_id asf::hashlife_automaton::empty(int level) {
+    while (static_cast<int>(empty_.size()) <= level) {
+        auto e = empty_.back();
+        empty_.push_back(join(e, e, e, e));
+    }
+    return empty_[level];
+}
+
+// the node one level down made of the four grandchildren around the center of n.
+asf::hashlife_automaton::node_id asf::hashlife_automaton::centre(node_id n) {
+    auto c = nodes_[n].children;
+    return join(
+        nodes_[c[k_nw]].children[k_se],
+        nodes_[c[k_ne]].children[k_sw],
+        nodes_[c[k_sw]].children[k_ne],
+        nodes_[c[k_se]].children[k_nw]
+    );
+}
+
+// the node one level up with n at its center and empty space around it.
+asf::hashlife_automaton::node_id asf::hashlife_automaton::expand(node_id n) {
+    auto c = nodes_[n].children;
+    auto e = empty(nodes_[n].level - 1);
+    return join(
+        join(e, e, e, c[k_nw]),
+        join(e, e, c[k_ne], e),
+        join(e, c[k_sw], e, e),
+        join(c[k_se], e, e, e)
+    );
+}
+
+// the center of a 4x4 node, i.e. a 2x2 node, after one step. In the sheared frame the
+// neighbors of the cell at column x and row y are (x +/- 1, y), (x, y - 1), (x + 1, y - 1),
+// (x, y + 1) and (x - 1, y + 1).
+asf::hashlife_automaton::node_id asf::hashlife_automaton::step_base(node_id n) {
+    auto c = nodes_[n].children;
+    auto cell = [&](int row, int col) -> int {
+        auto child = c[(row / 2) * 2 + col / 2];
+        return static_cast<int>(nodes_[child].children[(row % 2) * 2 + col % 2]);
+    };
+    auto next = [&](int row, int col) -> node_id {
+        int sum = cell(row, col + 1) + cell(row, col - 1) +
+            cell(row - 1, col) + cell(row - 1, col + 1) +
+            cell(row + 1, col) + cell(row + 1, col - 1);
+        return rules_[cell(row, col) * rules_stride_ + sum];
+    };
+    return join(next(1, 1), next(1, 2), next(2, 1), next(2, 2));
+}
+
+// the center half of n, a node of level k, after 2^log_steps steps, where log_steps is at
+// most k - 2.
+asf::hashlife_automaton::node_id asf::hashlife_automaton::successor(node_id n, int log_steps) {
+    auto [level, c, population] = nodes_[n];
+    if (population == 0) {
+        return empty(level - 1);
+    }
+    auto key = (uint64_t{ n } << 5) | static_cast<uint64_t>(log_steps);
+    auto it = successors_.find(key);
+    if (it != successors_.end()) {
+        return it->second;
+    }
+
+    node_id result;
+    if (level == 2) {
+        result = step_base(n);
+    } else {
+        auto nw = nodes_[c[k_nw]].children;
+        auto ne = nodes_[c[k_ne]].children;
+        auto sw = nodes_[c[k_sw]].children;
+        auto se = nodes_[c[k_se]].children;
+
+        // the nine overlapping nodes one level down that tile n in a 3x3 pattern.
+        std::array<node_id, 9> parts = {
+            c[k_nw],
+            join(nw[k_ne], ne[k_nw], nw[k_se], ne[k_sw]),
+            c[k_ne],
+            join(nw[k_sw], nw[k_se], sw[k_nw], sw[k_ne]),
+            centre(n),
+            join(ne[k_sw], ne[k_se], se[k_nw], se[k_ne]),
+            c[k_sw],
+            join(sw[k_ne], se[k_nw], sw[k_se], se[k_sw]),
+            c[k_se]
+        };
+
+        // a full-speed step advances each of the nine by half of the steps and the four
+        // nodes they make up by the other half; a shorter step just takes their centers
+        // and advances the four nodes by all of the steps.
+        bool full_speed = (log_steps == level - 2);
+        int inner_log_steps = full_speed ? log_steps - 1 : log_steps;
+        for (auto& part : parts) {
+            part = full_speed ? successor(part, inner_log_steps) : centre(part);
+        }
+        auto quarter = [&](int i) {
+            return successor(
+                join(parts[i], parts[i + 1], parts[i + 3], parts[i + 4]),
+                inner_log_steps
+            );
+        };
+        auto q_nw = quarter(0);
+        auto q_ne = quarter(1);
+        auto q_sw = quarter(3);
+        auto q_se = quarter(4);
+        result = join(q_nw, q_ne, q_sw, q_se);
+    }
+
+    successors_.emplace(key, result);
+    return result;
+}
+
+// n with the cell at column x and row y of its square set to state.
+asf::hashlife_automaton::node_id asf::hashlife_automaton::set_cell(
+        node_id n, int x, int y, uint8_t state) {
+    int level = nodes_[n].level;
+    if (level == 0) {
+        return state;
+    }
+    int half = 1 << (level - 1);
+    auto c = nodes_[n].children;
+    int i = (y >= half ? 2 : 0) + (x >= half ? 1 : 0);
+    c[i] = set_cell(c[i], x % half, y % half, state);
+    return join(c[k_nw], c[k_ne], c[k_sw], c[k_se]);
+}
+
+// the copy of node n of `from` in the current tables.
+asf::hashlife_automaton::node_id asf::hashlife_automaton::copy(
+        node_id n, const std::vector<node>& from, std::unordered_map<node_id, node_id>& copied) {
+    if (from[n].level == 0) {
+        return n;
+    }
+    auto it = copied.find(n);
+    if (it != copied.end()) {
+        return it->second;
+    }
+    auto c = from[n].children;
+    auto nw = copy(c[k_nw], from, copied);
+    auto ne = copy(c[k_ne], from, copied);
+    auto sw = copy(c[k_sw], from, copied);
+    auto se = copy(c[k_se], from, copied);
+    auto id = join(nw, ne, sw, se);
+    copied.emplace(n, id);
+    return id;
+}
+
+void asf::hashlife_automaton::collect_garbage() {
+    auto old_nodes = std::move(nodes_);
+    nodes_.assign(old_nodes.begin(), old_nodes.begin() + num_leaves_);
+    interned_.clear();
+    successors_.clear();
+    empty_.assign(1, 0);
+
+    std::unordered_map<node_id, node_id> copied;
+    root_ = copy(root_, old_nodes, copied);
+}
+
+void asf::hashlife_automaton::advance(int generations) {
+    // advance by powers of two, padding the root each time so that the pattern cannot grow
+    // out of its center half.
+    auto max_nodes = node_budget(radius_ + generations);
+    radius_ += generations;
+    while (generations > 0) {
+        int log_steps = std::min(
+            k_max_log_steps, static_cast<int>(std::bit_width(static_cast<unsigned>(generations))) - 1
+        );
+        while (nodes_[root_].level < log_steps + k_min_root_level ||
+                nodes_[centre(centre(root_))].population != nodes_[root_].population) {
+            root_ = expand(root_);
+        }
+        root_ = successor(root_, log_steps);
+        generations -= 1 << log_steps;
+
+        if (nodes_.size() > max_nodes) {
+            collect_garbage();
+        }
+    }
+}
+
+void asf::hashlife_automaton::collect(node_id n, int x0, int y0, hex_grid& grid) const {
+    const auto& nd = nodes_[n];
+    if (nd.population == 0) {
+        return;
+    }
+    if (nd.level == 0) {
+        grid[{ x0, y0, -x0 - y0 }] = static_cast<int>(n);
+        return;
+    }
+    int half = 1 << (nd.level - 1);
+    collect(nd.children[k_nw], x0, y0, grid);
+    collect(nd.children[k_ne], x0 + half, y0, grid);
+    collect(nd.children[k_sw], x0, y0 + half, grid);
+    collect(nd.children[k_se], x0 + half, y0 + half, grid);
+}
+
+asf::hex_grid asf::hashlife_automaton::to_hex_grid() const {
+    hex_grid grid;
+    int half = 1 << (nodes_[root_].level - 1);
+    collect(root_, -half, -half, grid);
+    return grid;
+}
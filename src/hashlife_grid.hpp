@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton with the hashlife algorithm, on a quadtree of hash-consed
+    // macro-cells in a square frame that hex coordinates are sheared into. A run advances at
+    // most 64 generations at a time and drops its memo tables when they outgrow a budget.
+
+    class hashlife_automaton {
+    public:
+        hashlife_automaton(const hex_grid& seed, const state_table& tbl);
+
+        void advance(int generations);
+        hex_grid to_hex_grid() const;
+
+    private:
+        using node_id = uint32_t;
+        using quad = std::array<node_id, 4>;
+
+        struct node {
+            int level;
+            quad children;
+            uint64_t population;
+        };
+
+        struct quad_hash {
+            size_t operator()(const quad& q) const;
+        };
+
+        node_id join(node_id nw, node_id ne, node_id sw, node_id se);
+        node_id empty(int level);
+        node_id centre(node_id n);
+        node_id expand(node_id n);
+        node_id successor(node_id n, int log_steps);
+        node_id step_base(node_id n);
+        node_id set_cell(node_id n, int x, int y, uint8_t state);
+        node_id copy(node_id n, const std::vector<node>& from,
+            std::unordered_map<node_id, node_id>& copied);
+        void collect_garbage();
+        void collect(node_id n, int x0, int y0, hex_grid& grid) const;
+
+        std::vector<node> nodes_;
+        std::unordered_map<quad, node_id, quad_hash> interned_;
+        std::unordered_map<uint64_t, node_id> successors_;
+        std::vector<node_id> empty_;
+        std::vector<uint8_t> rules_;
+        int rules_stride_;
+        int num_leaves_;
+        int radius_;
+        node_id root_;
+    };
+
+}
@@ -1,6 +1,10 @@
 #include "hex_grid.hpp"
+#include "chunked_grid.hpp"
+#include "mapped_grid.hpp"
 #include <print>
 #include <algorithm>
+#include <climits>
+#include <string>
 
 namespace r = std::ranges;
 namespace rv = std::ranges::views;
@@ -26,7 +30,8 @@ namespace {
         return { x,y };
     }
 
-    squ_grid to_squ_grid(const asf::hex_grid& grid) {
+    template<typename Grid>
+    squ_grid to_squ_grid(const Grid& grid) {
         return grid | rv::transform(
             [](auto&& cell) {
                 return rv::iota(0, 2) | rv::transform(
@@ -41,45 +46,98 @@ namespace {
         ) | rv::join | r::to<squ_grid>();
     }
 
-    asf::hex_coords rotate(const asf::hex_coords& hex, int n) {
-        auto sign = (n % 2 == 0) ? 1 : -1;
-        std::array<int, 3> ary = { {hex.x,hex.y,hex.z} };
-        return {
-            sign * ary[(0 + n) % 3],
-            sign * ary[(1 + n) % 3],
-            sign * ary[(2 + n) % 3]
-        };
+    template<typename Grid>
+    void display_grid(const Grid& hexagons) {
+        auto grid = to_squ_grid(hexagons);
+        if (grid.empty()) {
+            return;
+        }
+
+        auto [x1, x2] = r::minmax(
+            grid | rv::transform([](auto&& itm) {return itm.first.x; })
+        );
+        auto [y1, y2] = r::minmax(
+            grid | rv::transform([](auto&& itm) {return itm.first.y; })
+        );
+        for (auto y = y1; y <= y2; ++y) {
+            std::print("  ");
+            for (auto x = x1; x <= x2; ++x) {
+                char tile = grid.contains({ x,y }) ? grid.at({ x,y }) : ' ';
+                std::print("{}", tile);
+            }
+            std::println("");
+        }
     }
 
 }
 
-void asf::display(const asf::hex_grid& hexagons) {
-    auto grid = to_squ_grid(hexagons);
-    if (grid.empty()) {
+void asf::display(const hex_grid& grid) {
+    display_grid(grid);
+}
+
+void asf::display(const chunked_grid& grid) {
+    display_grid(grid);
+}
+
+// draws the same picture as the display of a hex grid, but streams it row by row out of the
+// grid's storage: one pass finds the bounding box of the live cells and a second one prints
+// the rows, so no more than one row of text is ever held in memory.
+void asf::display(const mapped_grid& grid) {
+    int radius = grid.radius();
+    auto for_each_live_cell = [&](int y, auto&& f) {
+        for (int x = std::max(-radius, -radius - y); x <= std::min(radius, radius - y); ++x) {
+            auto state = grid.at({ x, y, -x - y });
+            if (state > 0) {
+                f(x, state);
+            }
+        }
+    };
+
+    int x1 = INT_MAX;
+    int x2 = INT_MIN;
+    int y1 = INT_MAX;
+    int y2 = INT_MIN;
+    for (int y = -radius; y <= radius; ++y) {
+        for_each_live_cell(y, [&](int x, int) {
+            auto loc = to_squ_coords({ x, y, -x - y });
+            x1 = std::min(x1, loc.x);
+            x2 = std::max(x2, loc.x + 1);
+            y1 = std::min(y1, loc.y);
+            y2 = std::max(y2, loc.y);
+        });
+    }
+    if (x1 > x2) {
         return;
     }
 
-    auto [x1, x2] = r::minmax(
-        grid | rv::transform([](auto&& itm) {return itm.first.x; })
-    );
-    auto [y1, y2] = r::minmax(
-        grid | rv::transform([](auto&& itm) {return itm.first.y; })
-    );
-    for (auto y = y1; y <= y2; ++y) {
-        std::print("  ");
-        for (auto x = x1; x <= x2; ++x) {
-            char tile = grid.contains({ x,y }) ? grid.at({ x,y }) : ' ';
-            std::print("{}", tile);
-        }
-        std::println("");
+    std::string line;
+    for (int row = y1; row <= y2; ++row) {
+        line.assign(x2 - x1 + 1, ' ');
+        int y = -row;
+        for_each_live_cell(y, [&](int x, int state) {
+            auto loc = to_squ_coords({ x, y, -x - y });
+            line[loc.x - x1] = k_open_tiles[state];
+            line[loc.x + 1 - x1] = k_close_tiles[state];
+        });
+        std::println("  {}", line);
     }
 }
 
+asf::hex_coords asf::rotate(const hex_coords& hex, int num_sixths) {
+    auto sign = (num_sixths % 2 == 0) ? 1 : -1;
+    std::array<int, 3> ary = { {hex.x,hex.y,hex.z} };
+    return {
+        sign * ary[(0 + num_sixths) % 3],
+        sign * ary[(1 + num_sixths) % 3],
+        sign * ary[(2 + num_sixths) % 3]
+    };
+}
+
 asf::hex_grid asf::rotate(const hex_grid& grid, int num_sixths) {
     return grid | rv::transform(
         [num_sixths](auto&& itm)->hex_grid::value_type {
             const auto& [hex, val] = itm;
-            return { ::rotate(hex, num_sixths), val };
+            return { rotate(hex, num_sixths), val };
         }
     ) | r::to<hex_grid>();
 }
@@ -110,3 +168,16 @@ int asf::distance(const hex_coords& a, const hex_coords& b) {
     auto diff = a - b;
     return (std::abs(diff.x) + std::abs(diff.y) + std::abs(diff.z)) / 2;
 }
+
+int asf::distance_from_origin(const hex_coords& hex) {
+    return distance(hex, { 0,0,0 });
+}
+
+// the distance from the origin of the farthest cell of the grid, or 0 if it is empty.
+int asf::max_radius(const hex_grid& grid) {
+    int radius = 0;
+    for (const auto& [hex, state] : grid) {
+        radius = std::max(radius, distance_from_origin(hex));
+    }
+    return radius;
+}
@@ -11,12 +11,21 @@ namespace asf {
     using hex_grid = vec3_map<int, int>;
     using hex_set = vec3_set<int>;
 
+    // the number of live cells in a grid and the distance from the origin of the farthest one.
+    struct grid_stats {
+        int live_count;
+        int radius;
+    };
+
     void display(const hex_grid& grid);
+    hex_coords rotate(const hex_coords& hex, int num_sixths);
     hex_grid rotate(const hex_grid& grid, int num_sixths);
     hex_coords flip_horz(const hex_coords& hex);
     hex_grid flip_horz(const hex_grid& grid);
     hex_grid union_(const hex_grid& g1, const hex_grid& g2);
     int distance(const hex_coords& a, const hex_coords& b);
+    int distance_from_origin(const hex_coords& hex);
+    int max_radius(const hex_grid& grid);
 
     inline auto neighbors(const hex_coords& hex, bool with_diagonals) {
         namespace rv = std::ranges::views;
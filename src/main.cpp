@@ -26,9 +26,14 @@ int main(int argc, char* args[]) {
 
 		auto snowflakes = asf::grow_snowflakes(settings);
 		for (const auto& snowflake : snowflakes) {
-			display(snowflake);
+			display(snowflake.grid);
 			std::println("");
 		}
+
+		if (settings.poster.iterations > 0 && !snowflakes.empty()) {
+			std::println("    poster after {} more iterations:\n", settings.poster.iterations);
+			render_poster(snowflakes.front(), settings);
+		}
 	}
 	catch (std::runtime_error err) {
 		report_error(err.what());
@@ -0,0 +1,248 @@
+#include "mapped_grid.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_guard = 1;
+    constexpr int k_tile_bits = 6;
+    constexpr int k_tile_size = 1 << k_tile_bits;
+    constexpr size_t k_tile_bytes = size_t{ k_tile_size } * k_tile_size;
+    constexpr int k_last = k_tile_size - 1;
+
+    // a tile together with a halo one cell wide.
+    constexpr int k_pitch = k_tile_size + 2;
+
+}
+
+#ifdef _WIN32
+
+asf::mapped_file::mapped_file(const std::string& path, size_t size) :
+        path_(path),
+        size_(size),
+        data_(nullptr),
+        file_(INVALID_HANDLE_VALUE),
+        mapping_(nullptr) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+        CREATE_ALWAYS, FILE_ATTRIBUTE_TEMPORARY, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("could not create scratch file: " + path);
+    }
+    auto high = static_cast<DWORD>(static_cast<uint64_t>(size) >> 32);
+    auto low = static_cast<DWORD>(size & 0xffffffffu);
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READWRITE, high, low, nullptr);
+    if (mapping_) {
+        data_ = static_cast<uint8_t*>(MapViewOfFile(mapping_, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    }
+    if (!data_) {
+        if (mapping_) {
+            CloseHandle(mapping_);
+        }
+        CloseHandle(file_);
+        DeleteFileA(path.c_str());
+        throw std::runtime_error("could not map scratch file: " + path);
+    }
+}
+
+asf::mapped_file::~mapped_file() {
+    UnmapViewOfFile(data_);
+    CloseHandle(mapping_);
+    CloseHandle(file_);
+    DeleteFileA(path_.c_str());
+}
+
+#else
+
+asf::mapped_file::mapped_file(const std::string& path, size_t size) :
+        path_(path),
+        size_(size),
+        data_(nullptr),
+        fd_(open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600)) {
+    if (fd_ < 0) {
+        throw std::runtime_error("could not create scratch file: " + path);
+    }
+    if (ftruncate(fd_, static_cast<off_t>(size)) == 0) {
+        auto p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        data_ = (p != MAP_FAILED) ? static_cast<uint8_t*>(p) : nullptr;
+    }
+    if (!data_) {
+        close(fd_);
+        std::remove(path.c_str());
+        throw std::runtime_error("could not map scratch file: " + path);
+    }
+}
+
+asf::mapped_file::~mapped_file() {
+    munmap(data_, size_);
+    close(fd_);
+    std::remove(path_.c_str());
+}
+
+#endif
+
+uint8_t* asf::mapped_file::data() const {
+    return data_;
+}
+
+size_t asf::mapped_file::size() const {
+    return size_;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::mapped_grid::mapped_grid(uint8_t* cells, int radius) :
+        cells_(cells),
+        radius_(radius),
+        tiles_per_side_((2 * (radius + k_guard) + 1 + k_last) / k_tile_size) {
+}
+
+size_t asf::mapped_grid::bytes(int radius) {
+    size_t tiles = (2 * (radius + k_guard) + 1 + k_last) / k_tile_size;
+    return tiles * tiles * k_tile_bytes;
+}
+
+int asf::mapped_grid::radius() const {
+    return radius_;
+}
+
+int asf::mapped_grid::tiles_per_side() const {
+    return tiles_per_side_;
+}
+
+uint8_t asf::mapped_grid::at(const hex_coords& hex) const {
+    int col = hex.x + radius_ + k_guard;
+    int row = hex.y + radius_ + k_guard;
+    const uint8_t* t = tile(col >> k_tile_bits, row >> k_tile_bits);
+    return t[(row & k_last) * k_tile_size + (col & k_last)];
+}
+
+void asf::mapped_grid::set(const hex_coords& hex, uint8_t state) {
+    int col = hex.x + radius_ + k_guard;
+    int row = hex.y + radius_ + k_guard;
+    uint8_t* t = tile(col >> k_tile_bits, row >> k_tile_bits);
+    t[(row & k_last) * k_tile_size + (col & k_last)] = state;
+}
+
+// the tile in the given column and row of tiles, or nullptr if there is none.
+uint8_t* asf::mapped_grid::tile(int tile_x, int tile_y) const {
+    if (tile_x < 0 || tile_y < 0 || tile_x >= tiles_per_side_ || tile_y >= tiles_per_side_) {
+        return nullptr;
+    }
+    return cells_ + (static_cast<size_t>(tile_y) * tiles_per_side_ + tile_x) * k_tile_bytes;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::mapped_automaton::mapped_automaton(const hex_grid& seed, const state_table& tbl,
+            int radius, const std::string& path) :
+        file_(path, 2 * mapped_grid::bytes(radius)),
+        current_(file_.data(), radius),
+        next_(file_.data() + mapped_grid::bytes(radius), radius),
+        rules_(flat_rules(tbl)),
+        step_row_(row_kernel_for(tbl.num_states())),
+        extent_(max_radius(seed)),
+        scratch_(k_pitch * k_pitch, 0),
+        scratch_next_(k_pitch * k_pitch, 0) {
+
+    for (const auto& [hex, state] : seed) {
+        if (distance_from_origin(hex) > radius) {
+            throw std::runtime_error("cell lies outside of mapped grid");
+        }
+        current_.set(hex, static_cast<uint8_t>(state));
+    }
+}
+
+// copies the tile of the current grid in the given column and row of tiles into the
+// scratch buffer, along with the edges of the neighboring tiles that its cells' neighbors
+// lie in.
+void asf::mapped_automaton::load_tile(int tile_x, int tile_y) {
+    std::fill(scratch_.begin(), scratch_.end(), 0);
+    auto copy_cell = [&](const uint8_t* t, int col, int row, int to) {
+        scratch_[to] = t[row * k_tile_size + col];
+    };
+
+    if (auto t = current_.tile(tile_x, tile_y)) {
+        for (int row = 0; row < k_tile_size; ++row) {
+            std::memcpy(&scratch_[(row + 1) * k_pitch + 1], t + row * k_tile_size, k_tile_size);
+        }
+    }
+    if (auto t = current_.tile(tile_x, tile_y - 1)) {
+        std::memcpy(&scratch_[1], t + k_last * k_tile_size, k_tile_size);
+    }
+    if (auto t = current_.tile(tile_x + 1, tile_y - 1)) {
+        copy_cell(t, 0, k_last, k_pitch - 1);
+    }
+    if (auto t = current_.tile(tile_x - 1, tile_y)) {
+        for (int row = 0; row < k_tile_size; ++row) {
+            copy_cell(t, k_last, row, (row + 1) * k_pitch);
+        }
+    }
+    if (auto t = current_.tile(tile_x + 1, tile_y)) {
+        for (int row = 0; row < k_tile_size; ++row) {
+            copy_cell(t, 0, row, (row + 1) * k_pitch + k_pitch - 1);
+        }
+    }
+    if (auto t = current_.tile(tile_x - 1, tile_y + 1)) {
+        copy_cell(t, k_last, 0, (k_pitch - 1) * k_pitch);
+    }
+    if (auto t = current_.tile(tile_x, tile_y + 1)) {
+        std::memcpy(&scratch_[(k_pitch - 1) * k_pitch + 1], t, k_tile_size);
+    }
+}
+
+void asf::mapped_automaton::step_tile(int tile_x, int tile_y) {
+    load_tile(tile_x, tile_y);
+    for (int row = 1; row <= k_tile_size; ++row) {
+        step_row_(scratch_.data(), scratch_next_.data(), k_pitch, rules_.data(),
+            row * k_pitch + 1, row * k_pitch + k_tile_size);
+    }
+    uint8_t* out = next_.tile(tile_x, tile_y);
+    for (int row = 0; row < k_tile_size; ++row) {
+        std::memcpy(out + row * k_tile_size, &scratch_next_[(row + 1) * k_pitch + 1], k_tile_size);
+    }
+}
+
+// only the tiles that overlap the hexagon the snowflake can have grown into are swept;
+// the others have always been empty and stay so.
+void asf::mapped_automaton::step() {
+    int extent = std::min(extent_ + 1, current_.radius());
+    int origin = current_.radius() + k_guard;
+    for (int tile_y = 0; tile_y < current_.tiles_per_side(); ++tile_y) {
+        int y1 = tile_y * k_tile_size - origin;
+        int y2 = y1 + k_last;
+        for (int tile_x = 0; tile_x < current_.tiles_per_side(); ++tile_x) {
+            int x1 = tile_x * k_tile_size - origin;
+            int x2 = x1 + k_last;
+            if (x2 < -extent || x1 > extent || y2 < -extent || y1 > extent ||
+                    x2 + y2 < -extent || x1 + y1 > extent) {
+                continue;
+            }
+            step_tile(tile_x, tile_y);
+        }
+    }
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+void asf::mapped_automaton::advance(int steps) {
+    for (int i = 0; i < steps; ++i) {
+        step();
+    }
+}
+
+const asf::mapped_grid& asf::mapped_automaton::grid() const {
+    return current_;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // a scratch file of the given size mapped into memory for reading and writing. The file
+    // is created, or truncated, and filled with zeros when it is opened, and deleted when it
+    // is closed.
+
+    class mapped_file {
+    public:
+        mapped_file(const std::string& path, size_t size);
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+        ~mapped_file();
+
+        uint8_t* data() const;
+        size_t size() const;
+
+    private:
+        std::string path_;
+        size_t size_;
+        uint8_t* data_;
+#ifdef _WIN32
+        void* file_;
+        void* mapping_;
+#else
+        int fd_;
+#endif
+    };
+
+    // a hexagon of the given radius with a ring of dead guard cells one deep, stored in
+    // memory that it does not own, typically a mapped file, as 64x64 tiles of one page each
+    // in row-of-tiles order.
+
+    class mapped_grid {
+    public:
+        mapped_grid(uint8_t* cells, int radius);
+
+        static size_t bytes(int radius);
+
+        int radius() const;
+        int tiles_per_side() const;
+        uint8_t at(const hex_coords& hex) const;
+        void set(const hex_coords& hex, uint8_t state);
+        uint8_t* tile(int tile_x, int tile_y) const;
+
+    private:
+        uint8_t* cells_;
+        int radius_;
+        int tiles_per_side_;
+    };
+
+    void display(const mapped_grid& grid);
+
+    // runs the cellular automaton out of core on the two halves of a mapped scratch file,
+    // stepping one tile at a time in file order.
+
+    class mapped_automaton {
+    public:
+        mapped_automaton(const hex_grid& seed, const state_table& tbl, int radius,
+            const std::string& path);
+
+        void advance(int steps);
+        void step();
+        const mapped_grid& grid() const;
+
+    private:
+        void load_tile(int tile_x, int tile_y);
+        void step_tile(int tile_x, int tile_y);
+
+        mapped_file file_;
+        mapped_grid current_;
+        mapped_grid next_;
+        std::vector<uint8_t> rules_;
+        row_kernel step_row_;
+        int extent_;
+        std::vector<uint8_t> scratch_;
+        std::vector<uint8_t> scratch_next_;
+    };
+
+}
@@ -0,0 +1,231 @@
+#include "packed_grid.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    constexpr int k_guard = 1;
+    constexpr int k_word_bytes = 8;
+    constexpr int k_cells_per_word = 2 * k_word_bytes;
+    constexpr uint64_t k_low_nibbles = 0x0f0f0f0f0f0f0f0full;
+    constexpr uint64_t k_nibble_ones = 0x1111111111111111ull;
+
+    uint64_t load_word(const uint8_t* p) {
+        uint64_t w = 0;
+        for (int i = 0; i < k_word_bytes; ++i) {
+            w |= uint64_t{ p[i] } << (8 * i);
+        }
+        return w;
+    }
+
+    void store_word(uint8_t* p, uint64_t w) {
+        for (int i = 0; i < k_word_bytes; ++i) {
+            p[i] = static_cast<uint8_t>(w >> (8 * i));
+        }
+    }
+
+    // spreads the eight nibbles of a 32-bit word over the eight bytes of a 64-bit word,
+    // the low nibble going to the low byte.
+    uint64_t spread_nibbles(uint32_t nibbles) {
+        uint64_t w = nibbles;
+        w = (w | (w << 16)) & 0x0000ffff0000ffffull;
+        w = (w | (w << 8)) & 0x00ff00ff00ff00ffull;
+        return (w | (w << 4)) & k_low_nibbles;
+    }
+
+    // the inverse of spread_nibbles, for bytes below 16.
+    uint32_t gather_nibbles(uint64_t bytes) {
+        auto w = bytes & k_low_nibbles;
+        w = (w | (w >> 4)) & 0x00ff00ff00ff00ffull;
+        w = (w | (w >> 8)) & 0x0000ffff0000ffffull;
+        return static_cast<uint32_t>(w | (w >> 16));
+    }
+
+    // bit 4i set if nibble i of w is not zero.
+    uint64_t nonzero_nibbles(uint64_t w) {
+        return (w | (w >> 1) | (w >> 2) | (w >> 3)) & k_nibble_ones;
+    }
+
+}
+
+asf::packed_grid::packed_grid(int radius) :
+        radius_(radius),
+        stride_(2 * (radius + k_guard) + 1),
+        row_bytes_((stride_ + k_cells_per_word - 1) / k_cells_per_word * k_word_bytes),
+        cells_(static_cast<size_t>(stride_) * row_bytes_, 0) {
+}
+
+asf::packed_grid::packed_grid(const hex_grid& grid, int radius) :
+        packed_grid(radius) {
+    for (const auto& [hex, state] : grid) {
+        if (distance_from_origin(hex) > radius_) {
+            throw std::runtime_error("cell lies outside of packed grid");
+        }
+        set(hex, static_cast<uint8_t>(state));
+    }
+}
+
+int asf::packed_grid::radius() const {
+    return radius_;
+}
+
+int asf::packed_grid::column(int x) const {
+    return x + radius_ + k_guard;
+}
+
+int asf::packed_grid::unpacked_stride() const {
+    return 2 * row_bytes_;
+}
+
+size_t asf::packed_grid::row_offset(int y) const {
+    return static_cast<size_t>(y + radius_ + k_guard) * row_bytes_;
+}
+
+uint8_t asf::packed_grid::at(const hex_coords& hex) const {
+    int col = column(hex.x);
+    auto byte = cells_[row_offset(hex.y) + col / 2];
+    return (col % 2 == 0) ? (byte & 0x0f) : (byte >> 4);
+}
+
+void asf::packed_grid::set(const hex_coords& hex, uint8_t state) {
+    int col = column(hex.x);
+    auto& byte = cells_[row_offset(hex.y) + col / 2];
+    byte = (col % 2 == 0) ?
+        static_cast<uint8_t>((byte & 0xf0) | state) :
+        static_cast<uint8_t>((byte & 0x0f) | (state << 4));
+}
+
+void asf::packed_grid::clear() {
+    std::fill(cells_.begin(), cells_.end(), 0);
+}
+
+// a hash of rows -extent through extent, where all of the live cells are. It hashes the same
+// as the whole buffer would.
+uint64_t asf::packed_grid::hash(int extent) const {
+    extent = std::min(extent, radius_);
+    auto first = row_offset(-extent);
+    auto size = static_cast<size_t>(2 * extent + 1) * row_bytes_;
+    return hash_sparse_bytes(&cells_[first], size, first);
+}
+
+// the stats of the live cells in rows -extent through extent, which outside of the hexagon
+// of radius `extent` are all dead. Live cells are counted and located a word at a time.
+asf::grid_stats asf::packed_grid::stats(int extent) const {
+    grid_stats stats = { 0, 0 };
+    extent = std::min(extent, radius_);
+    for (int y = -extent; y <= extent; ++y) {
+        const uint8_t* row = &cells_[row_offset(y)];
+        int first = -1;
+        int last = -1;
+        for (int w = 0; w < row_bytes_ / k_word_bytes; ++w) {
+            auto live = nonzero_nibbles(load_word(row + w * k_word_bytes));
+            if (live == 0) {
+                continue;
+            }
+            stats.live_count += std::popcount(live);
+            int base = w * k_cells_per_word;
+            first = (first < 0) ? base + std::countr_zero(live) / 4 : first;
+            last = base + (63 - std::countl_zero(live)) / 4;
+        }
+        if (first >= 0) {
+            int x1 = first - radius_ - k_guard;
+            int x2 = last - radius_ - k_guard;
+            stats.radius = std::max({
+                stats.radius,
+                distance_from_origin({ x1, y, -x1 - y }),
+                distance_from_origin({ x2, y, -x2 - y })
+            });
+        }
+    }
+    return stats;
+}
+
+void asf::packed_grid::unpack_row(int y, uint8_t* out) const {
+    const uint8_t* row = &cells_[row_offset(y)];
+    for (int i = 0; i < row_bytes_; i += 4) {
+        uint32_t nibbles = row[i] | (row[i + 1] << 8) | (row[i + 2] << 16) |
+            (static_cast<uint32_t>(row[i + 3]) << 24);
+        store_word(out + 2 * i, spread_nibbles(nibbles));
+    }
+}
+
+void asf::packed_grid::pack_row(int y, const uint8_t* in) {
+    uint8_t* row = &cells_[row_offset(y)];
+    for (int i = 0; i < row_bytes_; i += 4) {
+        auto nibbles = gather_nibbles(load_word(in + 2 * i));
+        for (int j = 0; j < 4; ++j) {
+            row[i + j] = static_cast<uint8_t>(nibbles >> (8 * j));
+        }
+    }
+}
+
+asf::hex_grid asf::packed_grid::to_hex_grid() const {
+    hex_grid grid;
+    for (int y = -radius_; y <= radius_; ++y) {
+        for (int x = std::max(-radius_, -radius_ - y); x <= std::min(radius_, radius_ - y); ++x) {
+            hex_coords hex = { x, y, -x - y };
+            auto state = at(hex);
+            if (state > 0) {
+                grid[hex] = state;
+            }
+        }
+    }
+    return grid;
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::packed_automaton::packed_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        current_(seed, radius),
+        next_(radius),
+        rules_(flat_rules(tbl)),
+        step_row_(row_kernel_for(tbl.num_states())),
+        rows_(4 * current_.unpacked_stride(), 0),
+        extent_(max_radius(seed)) {
+}
+
+void asf::packed_automaton::step() {
+    int extent = std::min(extent_ + 1, current_.radius());
+    int pitch = current_.unpacked_stride();
+
+    // the rows above, at and below the row being stepped, followed by the row of results.
+    uint8_t* window = rows_.data();
+    uint8_t* out = window + 3 * pitch;
+
+    current_.unpack_row(-extent - 1, window);
+    current_.unpack_row(-extent, window + pitch);
+    for (int y = -extent; y <= extent; ++y) {
+        current_.unpack_row(y + 1, window + 2 * pitch);
+        std::fill(out, out + pitch, 0);
+        int first_x = std::max(-extent, -extent - y);
+        int last_x = std::min(extent, extent - y);
+        step_row_(window + pitch, out, pitch, rules_.data(),
+            current_.column(first_x), current_.column(last_x));
+        next_.pack_row(y, out);
+        std::memmove(window, window + pitch, 2 * pitch);
+    }
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+uint64_t asf::packed_automaton::hash() const {
+    return current_.hash(extent_);
+}
+
+asf::grid_stats asf::packed_automaton::stats() const {
+    return current_.stats(extent_);
+}
+
+const asf::packed_grid& asf::packed_automaton::grid() const {
+    return current_;
+}
+
+asf::hex_grid asf::packed_automaton::to_hex_grid() const {
+    return current_.to_hex_grid();
+}
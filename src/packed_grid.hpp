@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // the same hexagon in axial coordinates as dense_grid, but with two cells packed into
+    // each byte, the even column in the low nibble, and rows padded to whole 64-bit words.
+
+    class packed_grid {
+    public:
+        explicit packed_grid(int radius = 0);
+        packed_grid(const hex_grid& grid, int radius);
+
+        int radius() const;
+        int column(int x) const;
+        int unpacked_stride() const;
+        uint8_t at(const hex_coords& hex) const;
+        void set(const hex_coords& hex, uint8_t state);
+        void clear();
+        uint64_t hash(int extent) const;
+        grid_stats stats(int extent) const;
+
+        // unpacks row y into unpacked_stride() bytes, one per cell, cell x landing at
+        // out[column(x)], and packs such a row of bytes back into row y.
+        void unpack_row(int y, uint8_t* out) const;
+        void pack_row(int y, const uint8_t* in);
+
+        hex_grid to_hex_grid() const;
+
+    private:
+        size_t row_offset(int y) const;
+
+        int radius_;
+        int stride_;
+        int row_bytes_;
+        std::vector<uint8_t> cells_;
+    };
+
+    // runs the cellular automaton on a pair of packed grids. Each step unpacks a sliding
+    // window of three rows into bytes, applies the same row kernel as dense_automaton and
+    // packs the result back into the next grid.
+
+    class packed_automaton {
+    public:
+        packed_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const packed_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        packed_grid current_;
+        packed_grid next_;
+        std::vector<uint8_t> rules_;
+        row_kernel step_row_;
+        std::vector<uint8_t> rows_;
+        int extent_;
+    };
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*------------------------------------------------------------------------------------------------*/
+
+// a thin wrapper over vectors of bytes, just wide enough for the dense engine's stencil
+// kernel. It has internal linkage so that the copies compiled for different instruction
+// sets are never merged.
+
+namespace asf::simd {
+
+    namespace {
+
+        // portable fallback: sixteen lanes processed one at a time.
+        struct scalar_bytes {
+            static constexpr int size = 16;
+            uint8_t v[size];
+
+            static scalar_bytes load(const uint8_t* p) {
+                scalar_bytes out;
+                std::memcpy(out.v, p, size);
+                return out;
+            }
+
+            static scalar_bytes broadcast(uint8_t b) {
+                scalar_bytes out;
+                std::memset(out.v, b, size);
+                return out;
+            }
+
+            void store(uint8_t* p) const {
+                std::memcpy(p, v, size);
+            }
+        };
+
+        inline scalar_bytes operator+(const scalar_bytes& a, const scalar_bytes& b) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = static_cast<uint8_t>(a.v[i] + b.v[i]);
+            }
+            return out;
+        }
+
+        inline scalar_bytes operator&(const scalar_bytes& a, const scalar_bytes& b) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = a.v[i] & b.v[i];
+            }
+            return out;
+        }
+
+        inline scalar_bytes operator|(const scalar_bytes& a, const scalar_bytes& b) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = a.v[i] | b.v[i];
+            }
+            return out;
+        }
+
+        // 0xff in the lanes where a and b are equal, otherwise 0.
+        inline scalar_bytes equal(const scalar_bytes& a, const scalar_bytes& b) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = (a.v[i] == b.v[i]) ? 0xff : 0;
+            }
+            return out;
+        }
+
+        // each lane shifted right by four bits, for lanes below 0x80.
+        inline scalar_bytes high_nibble(const scalar_bytes& a) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = a.v[i] >> 4;
+            }
+            return out;
+        }
+
+        // looks each lane's low four bits up in a sixteen byte table, for lanes below 0x80.
+        inline scalar_bytes lookup16(const uint8_t* table, const scalar_bytes& index) {
+            scalar_bytes out;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                out.v[i] = table[index.v[i] & 0x0f];
+            }
+            return out;
+        }
+
+        inline bool none(const scalar_bytes& a) {
+            uint8_t any = 0;
+            for (int i = 0; i < scalar_bytes::size; ++i) {
+                any |= a.v[i];
+            }
+            return any == 0;
+        }
+
+#if defined(__AVX2__)
+
+        struct avx2_bytes {
+            static constexpr int size = 32;
+            __m256i v;
+
+            static avx2_bytes load(const uint8_t* p) {
+                return { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)) };
+            }
+
+            static avx2_bytes broadcast(uint8_t b) {
+                return { _mm256_set1_epi8(static_cast<char>(b)) };
+            }
+
+            void store(uint8_t* p) const {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v);
+            }
+        };
+
+        inline avx2_bytes operator+(const avx2_bytes& a, const avx2_bytes& b) {
+            return { _mm256_add_epi8(a.v, b.v) };
+        }
+
+        inline avx2_bytes operator&(const avx2_bytes& a, const avx2_bytes& b) {
+            return { _mm256_and_si256(a.v, b.v) };
+        }
+
+        inline avx2_bytes operator|(const avx2_bytes& a, const avx2_bytes& b) {
+            return { _mm256_or_si256(a.v, b.v) };
+        }
+
+        inline avx2_bytes equal(const avx2_bytes& a, const avx2_bytes& b) {
+            return { _mm256_cmpeq_epi8(a.v, b.v) };
+        }
+
+        inline avx2_bytes high_nibble(const avx2_bytes& a) {
+            return { _mm256_and_si256(_mm256_srli_epi16(a.v, 4), _mm256_set1_epi8(0x0f)) };
+        }
+
+        inline avx2_bytes lookup16(const uint8_t* table, const avx2_bytes& index) {
+            auto tbl = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(table))
+            );
+            return { _mm256_shuffle_epi8(tbl, index.v) };
+        }
+
+        inline bool none(const avx2_bytes& a) {
+            return _mm256_testz_si256(a.v, a.v) != 0;
+        }
+
+#endif
+
+    }
+
+}
@@ -0,0 +1,102 @@
+#include "simd_grid.hpp"
+#include "simd_kernel.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    asf::simd_kernel select_kernel() {
+#if defined(ASF_AVX2_KERNEL) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        if (__builtin_cpu_supports("avx2")) {
+            return asf::simd_step_avx2;
+        }
+#endif
+        return asf::simd_step_scalar;
+    }
+
+    asf::simd_kernel best_kernel() {
+        static const asf::simd_kernel kernel = select_kernel();
+        return kernel;
+    }
+
+}
+
+void asf::simd_step_scalar(const simd_kernel_args& args, int first, int count) {
+    simd::step_run<simd::scalar_bytes>(args, first, count);
+}
+
+const char* asf::simd_kernel_name() {
+    return (best_kernel() == simd_step_scalar) ? "scalar" : "avx2";
+}
+
+/*------------------------------------------------------------------------------------------------*/
+
+asf::simd_automaton::simd_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        current_(context_.buffers().current),
+        next_(context_.buffers().next),
+        rules_(context_.buffers().rules),
+        rules_stride_(tbl.stride()),
+        num_states_(tbl.num_states()),
+        extent_(max_radius(seed)),
+        kernel_(best_kernel()) {
+
+    current_.reset(seed, radius);
+    next_.reset(radius);
+    flat_rules(tbl, rules_);
+
+    if (num_states_ > k_max_states) {
+        throw std::runtime_error("the simd engine supports at most 10 states");
+    }
+
+    using simd::k_segments;
+    using simd::k_segment_size;
+    tables_.resize(num_states_ * k_segments * k_segment_size, 0);
+    for (int state = 0; state < num_states_; ++state) {
+        for (int sum = 0; sum < std::min(rules_stride_, k_segments * k_segment_size); ++sum) {
+            tables_[state * k_segments * k_segment_size + sum] =
+                rules_[state * rules_stride_ + sum];
+        }
+    }
+}
+
+void asf::simd_automaton::step() {
+    int extent = std::min(extent_ + 1, current_.radius());
+    simd_kernel_args args = {
+        current_.data(),
+        next_.data(),
+        current_.stride(),
+        rules_.data(),
+        rules_stride_,
+        tables_.data(),
+        num_states_
+    };
+
+    for (int row = -extent; row <= extent; ++row) {
+        int first_col = std::max(-extent, -extent - row);
+        int last_col = std::min(extent, extent - row);
+        kernel_(args, current_.index({ first_col, row, -first_col - row }),
+            last_col - first_col + 1);
+    }
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+uint64_t asf::simd_automaton::hash() const {
+    return current_.hash(extent_);
+}
+
+asf::grid_stats asf::simd_automaton::stats() const {
+    return current_.stats(extent_);
+}
+
+const asf::dense_grid& asf::simd_automaton::grid() const {
+    return current_;
+}
+
+asf::hex_grid asf::simd_automaton::to_hex_grid() const {
+    return current_.to_hex_grid();
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "dense_grid.hpp"
+#include "simd_kernel_args.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // the name of the kernel that simd_automaton uses on this machine.
+    const char* simd_kernel_name();
+
+    // steps the same dense grids as dense_automaton with the widest vector kernel the CPU
+    // supports. Supports up to ten states.
+
+    class simd_automaton {
+    public:
+        simd_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const dense_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        simulation_context context_;
+        dense_grid& current_;
+        dense_grid& next_;
+        std::vector<uint8_t>& rules_;
+        int rules_stride_;
+        std::vector<uint8_t> tables_;
+        int num_states_;
+        int extent_;
+        simd_kernel kernel_;
+    };
+
+}
@@ -0,0 +1,7 @@
+// compiled with AVX2 enabled; only called when the CPU supports it.
+
+#include "simd_kernel.hpp"
+
+void asf::simd_step_avx2(const simd_kernel_args& args, int first, int count) {
+    simd::step_run<simd::avx2_bytes>(args, first, count);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "simd.hpp"
+#include "simd_kernel_args.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+// the dense engine's stencil kernel, written against the byte vector wrapper in simd.hpp.
+// Like the wrapper it has internal linkage, see there.
+
+namespace asf::simd {
+
+    namespace {
+
+        // neighbor sums stay below 64 with at most ten states, i.e. four table segments.
+        constexpr int k_segments = 4;
+        constexpr int k_segment_size = 16;
+
+        struct direct_deltas {
+            int d[6];
+        };
+
+        // the index deltas of the direct neighbors in order of asf::k_neighbor_offsets, worked
+        // out here rather than by asf::neighbor_deltas, which has external linkage.
+        direct_deltas direct_neighbor_deltas(int stride) {
+            return { { 1, 1 - stride, -stride, -1, stride - 1, stride } };
+        }
+
+        template<typename V>
+        void step_run(const simd_kernel_args& args, int first, int count) {
+            const uint8_t* src = args.src;
+            const auto [d0, d1, d2, d3, d4, d5] = direct_neighbor_deltas(args.stride).d;
+            int end = first + count;
+
+            int i = first;
+            for (; i + V::size <= end; i += V::size) {
+                auto center = V::load(src + i);
+                auto sum = V::load(src + i + d0) + V::load(src + i + d1) +
+                    V::load(src + i + d2) + V::load(src + i + d3) +
+                    V::load(src + i + d4) + V::load(src + i + d5);
+
+                auto zero = V::broadcast(0);
+                if (none(center | sum)) {
+                    zero.store(args.dst + i);
+                    continue;
+                }
+
+                auto segment = high_nibble(sum);
+                V in_segment[k_segments];
+                for (int seg = 0; seg < k_segments; ++seg) {
+                    in_segment[seg] = equal(segment, V::broadcast(static_cast<uint8_t>(seg)));
+                }
+
+                auto out = zero;
+                for (int state = 0; state < args.num_states; ++state) {
+                    auto is_state = equal(center, V::broadcast(static_cast<uint8_t>(state)));
+                    if (none(is_state)) {
+                        continue;
+                    }
+                    const uint8_t* table = args.tables + state * k_segments * k_segment_size;
+                    auto next = zero;
+                    for (int seg = 0; seg < k_segments; ++seg) {
+                        next = next |
+                            (lookup16(table + seg * k_segment_size, sum) & in_segment[seg]);
+                    }
+                    out = out | (next & is_state);
+                }
+                out.store(args.dst + i);
+            }
+
+            for (; i < end; ++i) {
+                int sum = src[i + d0] + src[i + d1] + src[i + d2] +
+                    src[i + d3] + src[i + d4] + src[i + d5];
+                args.dst[i] = args.rules[src[i] * args.rules_stride + sum];
+            }
+        }
+
+    }
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+/*------------------------------------------------------------------------------------------------*/
+
+// the interface between simd_automaton and its stencil kernels. The AVX2 kernel's translation
+// unit includes nothing else of the engine's, so that it compiles no inline or template code
+// with external linkage that the linker could pick over the copies the other units compile.
+
+namespace asf {
+
+    // what a stencil kernel needs to step a run of cells of a dense grid. `tables` holds,
+    // for each state, the state table row split into sixteen byte segments.
+    struct simd_kernel_args {
+        const uint8_t* src;
+        uint8_t* dst;
+        int stride;
+        const uint8_t* rules;
+        int rules_stride;
+        const uint8_t* tables;
+        int num_states;
+    };
+
+    using simd_kernel = void (*)(const simd_kernel_args& args, int first, int count);
+
+    void simd_step_scalar(const simd_kernel_args& args, int first, int count);
+#if defined(ASF_AVX2_KERNEL)
+    void simd_step_avx2(const simd_kernel_args& args, int first, int count);
+#endif
+
+}
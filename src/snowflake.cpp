@@ -1,12 +1,32 @@
 #include "snowflake.hpp"
 #include "util.hpp"
+#include "state_table.hpp"
+#include "sparse_grid.hpp"
+#include "dense_grid.hpp"
+#include "wedge_grid.hpp"
+#include "bitplane_grid.hpp"
+#include "simd_grid.hpp"
+#include "batch_grid.hpp"
+#include "packed_grid.hpp"
+#include "hashlife_grid.hpp"
+#include "tiled_grid.hpp"
+#include "chunked_grid.hpp"
+#include "adaptive_grid.hpp"
+#include "mapped_grid.hpp"
+#include "delta_grid.hpp"
+#include "grid_measures.hpp"
 #include <random>
 #include <ranges>
 #include <stack>
 #include <map>
+#include <optional>
 #include <tuple>
+#include <array>
 #include <print>
 #include <execution>
+#include <algorithm>
+#include <stdexcept>
+#include <thread>
 
 namespace r = std::ranges;
 namespace rv = std::ranges::views;
@@ -16,42 +36,14 @@ namespace rv = std::ranges::views;
 namespace {
 
     constexpr double k_connected_by_diagonals_score = 0.5;
+    constexpr int k_max_cycle_period = 4;
+    constexpr int k_num_gates = 3;
 
-
-    using state_table = std::vector<std::vector<int>>;
-
-    std::tuple<size_t, size_t> dimensions(const state_table& tbl) {
-        return {
-            tbl.at(0).size(),
-            tbl.size()
-        };
-    }
-
-    state_table empty_state_table(int cols, int rows) {
-        return rv::iota(
-            0, rows
-        ) | rv::transform(
-            [&](auto) {
-                return std::vector<int>(cols, 0);
-            }
-        ) | r::to<std::vector>();
-    }
-
-    state_table mix_state_tables(const state_table& tbl1, const state_table& tbl2) {
-        auto [cols, rows] = dimensions(tbl1);
-        auto child = empty_state_table(cols, rows);
-        for (int row = 0; row < rows; ++row) {
-            for (int col = 0; col < cols; ++col) {
-                child[row][col] = asf::random_chance(0.5) ? tbl1[row][col] : tbl2[row][col];
-            }
-        }
-        return child;
-    }
-
-    asf::hex_set active_cells(const asf::hex_grid& grid) {
+    template<typename Grid>
+    asf::hex_set active_cells(const Grid& grid, bool with_diagonals) {
         auto active = grid | rv::keys | rv::transform(
-            [](auto&& hex) {
-                return asf::neighbors(hex, false);
+            [with_diagonals](auto&& hex) {
+                return asf::neighbors(hex, with_diagonals);
             }
         ) | rv::join | r::to<asf::hex_set>();
         r::copy(grid | rv::keys, std::inserter(active, active.end()));
@@ -65,9 +57,9 @@ namespace {
         return grid.at(hex);
     }
 
-    int neighbor_sum(const asf::hex_grid& grid, const asf::hex_coords& hex) {
+    int neighbor_sum(const asf::hex_grid& grid, const asf::hex_coords& hex, bool with_diagonals) {
         return r::fold_left(
-            asf::neighbors(hex, false) | rv::transform(
+            asf::neighbors(hex, with_diagonals) | rv::transform(
                 [&](auto&& neighbor) {
                     return state_at(grid, neighbor);
                 }
@@ -77,59 +69,92 @@ namespace {
         );
     }
 
-    int neighbor_count(const asf::hex_grid& grid, const asf::hex_coords& hex) {
-        return r::fold_left(
-            asf::neighbors(hex, false) | rv::transform(
-                [&](auto&& neighbor) {
-                    return grid.contains(neighbor) ? 1 : 0;
-                }
-            ),
-            0,
-            std::plus<>()
-        );
-    }
+    // the number of connected components of the cells of a hex grid or hex set and the size
+    // of the largest, found by a depth-first search from each cell not yet visited.
+    struct component_count {
+        int components;
+        int largest;
+    };
 
     template<typename Grid>
-    bool is_connected(const Grid& grid, bool with_diagonals) {
-        if (grid.empty()) return true;
+    component_count count_components(const Grid& grid, bool with_diagonals) {
+        component_count count = { 0, 0 };
         asf::hex_set visited;
         std::stack<asf::hex_coords> stack;
+        for (const auto& cell : grid) {
+            asf::hex_coords start;
+            if constexpr (requires { cell.first; }) {
+                start = cell.first; // unordered_map
+            } else {
+                start = cell; // unordered_set
+            }
+            if (visited.contains(start)) {
+                continue;
+            }
 
-        // Extract initial key
-        if constexpr (requires { grid.begin()->first; }) {
-            stack.push(grid.begin()->first); // unordered_map
-        } else {
-            stack.push(*grid.begin()); // unordered_set
-        }
+            int size = 0;
+            stack.push(start);
+            while (!stack.empty()) {
+                auto current = stack.top();
+                stack.pop();
 
-        while (!stack.empty()) {
-            auto current = stack.top();
-            stack.pop();
+                if (visited.contains(current)) continue;
+                visited.insert(current);
+                ++size;
 
-            if (visited.contains(current)) continue;
-            visited.insert(current);
+                for (auto neighbor : asf::neighbors(current, with_diagonals)) {
+                    if (!grid.contains(neighbor)) continue;
+                    stack.push(neighbor);
+                }
+            }
+            ++count.components;
+            count.largest = std::max(count.largest, size);
+        }
+        return count;
+    }
 
-            for (auto neighbor : asf::neighbors(current, with_diagonals)) {
-                if (!grid.contains(neighbor)) continue;
-                stack.push(neighbor);
+    template<typename Grid>
+    bool is_connected(const Grid& grid, bool with_diagonals) {
+        return count_components(grid, with_diagonals).components <= 1;
+    }
+
+    // whether a dead cell is craggy: it has three or more live neighbors and they are
+    // connected among themselves.
+    template<typename Grid>
+    bool is_craggy(const Grid& grid, const asf::hex_coords& hex) {
+        auto neighbor_set = asf::neighbors(hex, false) | rv::filter(
+            [&](auto&& hex) {
+                return grid.contains(hex);
             }
+        ) | r::to<asf::hex_set>();
+        return neighbor_set.size() >= 3 && is_connected(neighbor_set, false);
+    }
+
+    // labels the components of a hex grid with the component labeler, on a dense copy of it
+    // made in the thread's spare dense buffers.
+    asf::grid_connectivity grid_connectivity(const asf::hex_grid& grid) {
+        asf::simulation_context context;
+        auto& scratch = context.buffers().current;
+        auto radius = max_radius(grid);
+        scratch.reset(radius);
+        for (const auto& [hex, state] : grid) {
+            scratch.set(hex, static_cast<uint8_t>(state));
         }
-        return visited.size() == grid.size();
+        return asf::measure_connectivity(scratch, radius);
     }
 
-    int max_radius(const asf::hex_grid& grid) {
-        if (grid.empty()) {
-            return 0;
+    double connectedness_score(const asf::grid_connectivity& connectivity) {
+        if (connectivity.direct_components <= 1) {
+            return 1.0;
         }
-        auto distance_from_origin = [](const asf::hex_coords& hex) {
-            return asf::distance(hex, { 0,0,0 });
-            };
-        return r::max(
-            grid | rv::keys | rv::transform(distance_from_origin)
-        );
+        if (connectivity.diagonal_components <= 1) {
+            return k_connected_by_diagonals_score;
+        }
+        return 0.0;
     }
 
-    double snowflake_airiness(const asf::hex_grid& grid, int radius) {
+    template<typename Grid>
+    double snowflake_airiness(const Grid& grid, int radius) {
         int total_count = 0;
         int air_count = 0;
         for (const auto& hex : asf::hex_region(radius)) {
@@ -139,29 +164,24 @@ namespace {
         return static_cast<double>(air_count) / static_cast<double>(total_count);
     }
 
-    double snowflake_cragginess(const asf::hex_grid& grid, int radius) {
+    template<typename Grid>
+    double snowflake_cragginess(const Grid& grid, int radius) {
         int periphery_cells = 0;
         int high_neighbor_cells = 0;
-        for (auto hex : active_cells(grid)) {
+        for (auto hex : active_cells(grid, false)) {
             if (grid.contains(hex)) {
                 continue;
             }
             periphery_cells++;
-            if (neighbor_count(grid, hex) >= 3) {
-                auto neighbor_set = asf::neighbors(hex, false) | rv::filter(
-                    [&](auto&& hex) {
-                        return grid.contains(hex);
-                    }
-                ) | r::to<asf::hex_set>();
-                if (is_connected(neighbor_set, false)) {
-                    high_neighbor_cells++;
-                }
+            if (is_craggy(grid, hex)) {
+                high_neighbor_cells++;
             }
         }
         return static_cast<double>(high_neighbor_cells) / static_cast<double>(periphery_cells);
     }
 
-    double snowflake_spikiness(const asf::hex_grid& grid, int radius) {
+    template<typename Grid>
+    double snowflake_spikiness(const Grid& grid, int radius) {
         int total_alive = 0;
         double alive_edge_proximity = 0.0;
 
@@ -192,7 +212,35 @@ namespace {
     struct snowflake_info {
         asf::hex_grid snowflake;
         double score;
-        state_table tbl;
+        asf::state_table tbl;
+        int pruned_at;
+        asf::representation_use usage;
+        int gates_passed;
+        std::optional<asf::grid_connectivity> connectivity;
+    };
+
+    struct pruning_stats {
+        int candidates;
+        int pruned;
+        int total_pruned_at;
+    };
+
+    // how many of the candidates that were scored rather than pruned reached each gate, by
+    // its position in the configured order, and how many of those the gate rejected.
+    struct gate_stats {
+        std::array<int, k_num_gates> reached;
+        std::array<int, k_num_gates> rejected;
+    };
+
+    // the components of the candidates that the connectedness gate labeled, summed over
+    // them: how many components each had, and what share of its live cells the largest
+    // held, with only direct and with diagonal neighbors adjacent.
+    struct component_stats {
+        int labeled;
+        int direct_components;
+        int diagonal_components;
+        double largest_direct_share;
+        double largest_diagonal_share;
     };
 
     asf::hex_grid random_initial_grid(double density, int num_states, int radius) {
@@ -217,29 +265,27 @@ namespace {
         return out;
     }
 
-    state_table random_state_table(double alive_prob, int num_states) {
-        int max_sum = 6 * num_states;
-        return rv::iota(
-            0, num_states
-        ) | rv::transform(
-            [&](auto) {
-                return rv::iota(0, max_sum + 1) | rv::transform(
-                    [&](auto) {
-                        if (asf::random_chance(1.0 - alive_prob)) {
-                            return 0;
-                        }
-                        return 1 + asf::random_int(num_states - 1);
-                    }
-                ) | r::to<std::vector>();
-            }
-        ) | r::to<std::vector>();
+    // the column of the state table for a cell: the sum of its direct neighbors, the sum of
+    // its direct and diagonal neighbors, or the pair of the two sums.
+    int table_column(const asf::hex_grid& grid, const asf::hex_coords& hex,
+            const asf::state_table& tbl) {
+        auto direct_sum = neighbor_sum(grid, hex, false);
+        if (tbl.neighborhood() == asf::neighborhood_type::direct) {
+            return direct_sum;
+        }
+        auto diagonal_sum = neighbor_sum(grid, hex, true) - direct_sum;
+        if (tbl.neighborhood() == asf::neighborhood_type::split) {
+            return asf::split_sum(tbl.num_states(), direct_sum, diagonal_sum);
+        }
+        return direct_sum + diagonal_sum;
     }
 
-    asf::hex_grid do_cellular_automata_step(const asf::hex_grid& current, const state_table& tbl) {
+    asf::hex_grid do_cellular_automata_step(const asf::hex_grid& current, const asf::state_table& tbl) {
         asf::hex_grid next;
-        for (auto hex : active_cells(current)) {
-            auto sum = neighbor_sum(current, hex);
-            auto next_state = tbl[state_at(current, hex)][sum];
+        bool with_diagonals = tbl.neighborhood() != asf::neighborhood_type::direct;
+        for (auto hex : active_cells(current, with_diagonals)) {
+            auto sum = table_column(current, hex, tbl);
+            auto next_state = tbl(state_at(current, hex), sum);
             if (next_state > 0) {
                 next[hex] = next_state;
             }
@@ -247,7 +293,10 @@ namespace {
         return next;
     }
 
-    double score_snowflake(const asf::hex_grid& grid, const asf::snowflake_metric_params& params) {
+    // scores a hex grid or any grid that reads like one, metric by metric; this is the
+    // reference that cross_check holds the scoring pipeline to.
+    template<typename Grid>
+    double score_snowflake(const Grid& grid, const asf::snowflake_metric_params& params) {
         double connectedness = 0.0;
         if (is_connected(grid, false)) {
             connectedness = 1.0;
@@ -279,14 +328,495 @@ namespace {
             params.spikiness_weight * spikiness;
     }
 
-    snowflake_info generate_snowflake(
-            const asf::hex_grid& initial_configuration, const state_table& tbl, 
+    // the airiness of a snowflake with the given number of live cells and radius, since
+    // every live cell lies within the hexagon of the snowflake's radius.
+    double airiness_of(int live_count, int radius) {
+        int total_count = 3 * radius * (radius + 1) + 1;
+        return static_cast<double>(total_count - live_count) / static_cast<double>(total_count);
+    }
+
+    bool is_in_range(int radius, const asf::snowflake_metric_params& params) {
+        return radius >= params.min_radius && radius <= params.max_radius;
+    }
+
+    bool is_in_range(double density, const asf::snowflake_metric_params& params) {
+        return density >= params.min_density && density <= params.max_density;
+    }
+
+    // the score of a snowflake that has passed every gate, from its measures; every division
+    // and sum is done on the same values in the same order as in score_snowflake, so the two
+    // agree to the last bit.
+    double weighted_score(double connectedness, double airiness,
+            const asf::grid_measures& measures, const asf::snowflake_metric_params& params) {
+        auto cragginess = static_cast<double>(measures.craggy_count) /
+            static_cast<double>(measures.periphery_count);
+        auto spikiness = measures.spike_count > 0
+            ? measures.spike_sum / static_cast<double>(measures.spike_count)
+            : 0.0;
+
+        return params.connectedness_weight * connectedness +
+            params.airiness_weight * airiness +
+            params.cragginess_weight * cragginess +
+            params.spikiness_weight * spikiness;
+    }
+
+    // scores a hex grid in one sweep over the whole of a dense copy of it, made in the
+    // thread's spare dense buffers, running the gates in their original order.
+    double score_dense(const asf::hex_grid& grid, const asf::snowflake_metric_params& params) {
+        asf::simulation_context context;
+        auto& scratch = context.buffers().current;
+        auto radius = max_radius(grid);
+        scratch.reset(grid, radius);
+        auto measures = asf::measure_grid(scratch, radius);
+
+        auto connectedness = connectedness_score(measures.connectivity);
+        if (connectedness == 0.0 || !is_in_range(measures.radius, params)) {
+            return 0.0;
+        }
+        auto airiness = airiness_of(measures.live_count, measures.radius);
+        if (!is_in_range(1.0 - airiness, params)) {
+            return 0.0;
+        }
+        return weighted_score(connectedness, airiness, measures, params);
+    }
+
+    struct scoring_result {
+        double score;
+        int gates_passed;
+        std::optional<asf::grid_connectivity> connectivity;
+    };
+
+    // scores a grown snowflake, a hex grid or any grid that reads like one, given the stats
+    // its run ended with, running the gates in the configured order.
+    template<typename Grid>
+    scoring_result score_pipeline(const Grid& grid, const asf::grid_stats& stats,
+            const asf::settings& settings) {
+        const auto& params = settings.score_params;
+        asf::simulation_context context;
+        auto& scratch = context.buffers().current;
+        bool copied = false;
+        auto dense_copy = [&]() -> const asf::dense_grid& {
+            if (!copied) {
+                scratch.reset(stats.radius);
+                for (const auto& [hex, state] : grid) {
+                    scratch.set(hex, static_cast<uint8_t>(state));
+                }
+                copied = true;
+            }
+            return scratch;
+        };
+
+        auto airiness = airiness_of(stats.live_count, stats.radius);
+        double connectedness = 0.0;
+        std::optional<asf::grid_connectivity> connectivity;
+        int gates_passed = 0;
+        for (auto gate : settings.score_order) {
+            bool passed = true;
+            switch (gate) {
+                case asf::score_gate::radius:
+                    passed = is_in_range(stats.radius, params);
+                    break;
+                case asf::score_gate::density:
+                    passed = is_in_range(1.0 - airiness, params);
+                    break;
+                case asf::score_gate::connectedness:
+                    connectivity = asf::measure_connectivity(dense_copy(), stats.radius);
+                    connectedness = connectedness_score(*connectivity);
+                    passed = connectedness != 0.0;
+                    break;
+            }
+            if (!passed) {
+                return { 0.0, gates_passed, connectivity };
+            }
+            ++gates_passed;
+        }
+
+        auto measures = asf::measure_symmetric_grid(dense_copy(), stats.radius);
+        return {
+            weighted_score(connectedness, airiness, measures, params), gates_passed, connectivity
+        };
+    }
+
+    int light_cone_radius(const asf::settings& settings) {
+        return static_cast<int>(settings.primordial_soup_radius) +
+            asf::reach(settings.neighborhood) * settings.num_iterations;
+    }
+
+    // remembers the hashes of the last few states of a run so that the run can tell when
+    // it has reached a fixed point or a short cycle; an empty grid is a fixed point.
+    class cycle_detector {
+    public:
+        // records the hash of the newest state and returns the period of the cycle that
+        // the run has entered, or 0 if it has not entered one.
+        int update(uint64_t hash) {
+            int period = 0;
+            for (int p = 1; p <= std::min(count_, k_max_cycle_period); ++p) {
+                if (history_[(count_ - p) % k_max_cycle_period] == hash) {
+                    period = p;
+                    break;
+                }
+            }
+            history_[count_ % k_max_cycle_period] = hash;
+            ++count_;
+            return period;
+        }
+
+    private:
+        std::array<uint64_t, k_max_cycle_period> history_ = {};
+        int count_ = 0;
+    };
+
+    // true if no live cell can ever die under the table, in which case the radius of a
+    // snowflake can only grow.
+    bool never_kills(const asf::state_table& tbl) {
+        return std::all_of(
+            tbl.data() + tbl.stride(),
+            tbl.data() + tbl.num_states() * tbl.stride(),
+            [](uint8_t next_state) {
+                return next_state > 0;
+            }
+        );
+    }
+
+    // true if a run with the given stats, which can grow by at most growth_left more cells,
+    // can no longer end with a radius in range.
+    bool is_hopeless(const asf::grid_stats& stats, int growth_left, bool monotonic,
+            const asf::snowflake_metric_params& params) {
+        if (stats.live_count == 0) {
+            return params.min_radius > 0;
+        }
+        return stats.radius + growth_left < params.min_radius ||
+            (monotonic && stats.radius > params.max_radius);
+    }
+
+    template<typename Automaton>
+    void advance(Automaton& automaton, int steps) {
+        if constexpr (requires { automaton.advance(steps); }) {
+            automaton.advance(steps);
+        } else {
+            for (int i = 0; i < steps; ++i) {
+                automaton.step();
+            }
+        }
+    }
+
+    struct run_result {
+        asf::hex_grid grid;
+        asf::grid_stats stats;
+        int pruned_at;
+        asf::representation_use usage = {};
+    };
+
+    // runs the automaton for the configured number of iterations, stopping early or pruning
+    // as configured; returns the step at which the run was pruned, or 0.
+    template<typename Automaton>
+    int run_steps(Automaton& automaton, const asf::state_table& tbl,
+            const asf::settings& settings) {
+        bool monotonic = settings.prune && never_kills(tbl);
+        int growth = asf::reach(tbl.neighborhood());
+        // engines that advance several steps at a time are checked once per block of steps;
+        // a cycle of blocks is a cycle of period * block steps.
+        int block = 1;
+        if constexpr (requires { automaton.block_steps(); }) {
+            block = automaton.block_steps();
+        }
+        cycle_detector cycles;
+        if (settings.stop_early) {
+            cycles.update(automaton.hash());
+        }
+        for (int i = 0; i < settings.num_iterations; ) {
+            int steps = std::min(block, settings.num_iterations - i);
+            advance(automaton, steps);
+            i += steps;
+            int steps_left = settings.num_iterations - i;
+            if (settings.prune &&
+                    is_hopeless(automaton.stats(), growth * steps_left, monotonic,
+                        settings.score_params)) {
+                return i;
+            }
+            if (!settings.stop_early) {
+                continue;
+            }
+            auto period = cycles.update(automaton.hash());
+            if (period > 0) {
+                for (int j = steps_left % (period * block); j > 0; j -= block) {
+                    advance(automaton, std::min(block, j));
+                }
+                break;
+            }
+        }
+        return 0;
+    }
+
+    // engines that can split a step across threads are allowed to when parallel_step is set.
+    template<typename Automaton>
+    run_result run_automaton(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
+            const asf::settings& settings, bool parallel_step) {
+        Automaton automaton(initial_configuration, tbl, light_cone_radius(settings));
+        if constexpr (requires { automaton.set_parallel(parallel_step); }) {
+            automaton.set_parallel(parallel_step);
+        }
+        auto pruned_at = run_steps(automaton, tbl, settings);
+        return { automaton.to_hex_grid(), automaton.stats(), pruned_at };
+    }
+
+    asf::hex_grid run_sparse_automaton(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
             const asf::settings& settings) {
         auto state = initial_configuration;
         for (int i = 0; i < settings.num_iterations; ++i) {
             state = do_cellular_automata_step(state, tbl);
         }
-        return { state, score_snowflake(state, settings.score_params), tbl };
+        return state;
+    }
+
+    // hashlife advances the whole run at once, so it neither stops early nor prunes; it
+    // does not need to.
+    run_result run_hashlife(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
+            const asf::settings& settings) {
+        asf::hashlife_automaton automaton(initial_configuration, tbl);
+        automaton.advance(settings.num_iterations);
+        auto grid = automaton.to_hex_grid();
+        asf::grid_stats stats = { static_cast<int>(grid.size()), max_radius(grid) };
+        return { std::move(grid), stats, 0 };
+    }
+
+    run_result run_adaptive(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
+            const asf::settings& settings, bool parallel_step) {
+        asf::adaptive_automaton automaton(
+            initial_configuration, tbl, light_cone_radius(settings), settings.switching
+        );
+        automaton.set_parallel(parallel_step);
+        auto pruned_at = run_steps(automaton, tbl, settings);
+        return { automaton.to_hex_grid(), automaton.stats(), pruned_at, automaton.usage() };
+    }
+
+    run_result run_engine(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
+            const asf::settings& settings, bool parallel_step) {
+        const auto& seed = initial_configuration;
+        switch (settings.engine) {
+            case asf::engine_type::dense:
+                return run_automaton<asf::dense_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::wedge:
+                return run_automaton<asf::wedge_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::bitplane:
+                return run_automaton<asf::bitplane_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::simd:
+                return run_automaton<asf::simd_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::packed:
+                return run_automaton<asf::packed_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::tiled:
+                return run_automaton<asf::tiled_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::delta:
+                return run_automaton<asf::delta_automaton>(seed, tbl, settings, parallel_step);
+            case asf::engine_type::hashlife:
+                return run_hashlife(seed, tbl, settings);
+            case asf::engine_type::adaptive:
+                return run_adaptive(seed, tbl, settings, parallel_step);
+            default:
+                return run_automaton<asf::sparse_automaton>(seed, tbl, settings, parallel_step);
+        }
+    }
+
+    // runs the candidates work_items[first] through work_items[first + count - 1] in lockstep
+    // on one batch automaton. A candidate is done when it is pruned or, with early stopping
+    // on, when it reaches a fixed point; the batch stops once all of its candidates are done.
+    std::vector<run_result> run_batch(
+            const std::vector<std::tuple<asf::state_table, asf::hex_grid>>& work_items,
+            int first, int count, const asf::settings& settings) {
+        asf::batch_automaton batch(light_cone_radius(settings), settings.num_states, count);
+        std::vector<uint8_t> monotonic(count, 0);
+        for (int lane = 0; lane < count; ++lane) {
+            const auto& [tbl, seed] = work_items[first + lane];
+            batch.load(lane, seed, tbl);
+            monotonic[lane] = settings.prune && never_kills(tbl);
+        }
+
+        std::vector<int> pruned_at(count, 0);
+        std::vector<uint8_t> done(count, 0);
+        for (int i = 0; i < settings.num_iterations; ++i) {
+            batch.step();
+            int steps_left = settings.num_iterations - i - 1;
+            bool all_done = true;
+            for (int lane = 0; lane < count; ++lane) {
+                if (done[lane]) {
+                    continue;
+                }
+                if (settings.prune && is_hopeless(batch.stats(lane), steps_left, monotonic[lane],
+                        settings.score_params)) {
+                    pruned_at[lane] = i + 1;
+                    done[lane] = 1;
+                } else if (settings.stop_early && !batch.changed(lane)) {
+                    done[lane] = 1;
+                } else {
+                    all_done = false;
+                }
+            }
+            if (all_done) {
+                break;
+            }
+        }
+
+        return rv::iota(0, count) | rv::transform(
+            [&](int lane) {
+                return run_result{ batch.to_hex_grid(lane), batch.stats(lane), pruned_at[lane] };
+            }
+        ) | r::to<std::vector>();
+    }
+
+    snowflake_info score_run(
+            run_result&& result, const asf::state_table& tbl, const asf::settings& settings) {
+        if (result.pruned_at > 0) {
+            return { std::move(result.grid), 0.0, tbl, result.pruned_at, result.usage, 0, {} };
+        }
+        auto [score, gates_passed, connectivity] =
+            score_pipeline(result.grid, result.stats, settings);
+        return {
+            std::move(result.grid), score, tbl, 0, result.usage, gates_passed, connectivity
+        };
+    }
+
+    // the chunked engine scores the chunked grid it grew directly, without converting it
+    // to a hex grid first.
+    snowflake_info generate_chunked_snowflake(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl,
+            const asf::settings& settings) {
+        asf::chunked_automaton automaton(initial_configuration, tbl, light_cone_radius(settings));
+        auto pruned_at = run_steps(automaton, tbl, settings);
+        if (pruned_at > 0) {
+            return { automaton.to_hex_grid(), 0.0, tbl, pruned_at, {}, 0, {} };
+        }
+        auto [score, gates_passed, connectivity] =
+            score_pipeline(automaton.grid(), automaton.stats(), settings);
+        return { automaton.to_hex_grid(), score, tbl, 0, {}, gates_passed, connectivity };
+    }
+
+    snowflake_info generate_snowflake(
+            const asf::hex_grid& initial_configuration, const asf::state_table& tbl, 
+            const asf::settings& settings, bool parallel_step) {
+        if (settings.engine == asf::engine_type::chunked) {
+            return generate_chunked_snowflake(initial_configuration, tbl, settings);
+        }
+        return score_run(
+            run_engine(initial_configuration, tbl, settings, parallel_step), tbl, settings
+        );
+    }
+
+    // grows and scores every candidate in parallel, one candidate per task or, with the batch
+    // engine, one batch of candidates per task. With fewer candidates than cores, the steps
+    // of large runs are themselves split across threads by the engines that support it.
+    std::vector<snowflake_info> generate_snowflakes(
+            const std::vector<std::tuple<asf::state_table, asf::hex_grid>>& work_items,
+            const asf::settings& settings) {
+        std::vector<snowflake_info> snowflakes(work_items.size());
+        bool parallel_step = work_items.size() < std::thread::hardware_concurrency();
+        if (settings.engine != asf::engine_type::batch) {
+            std::transform(
+                std::execution::par,
+                work_items.begin(),
+                work_items.end(),
+                snowflakes.begin(),
+                [&](const auto& work_item) {
+                    const auto& [tbl, seed] = work_item;
+                    return generate_snowflake(seed, tbl, settings, parallel_step);
+                }
+            );
+            return snowflakes;
+        }
+
+        int num_items = static_cast<int>(work_items.size());
+        int lanes = asf::batch_lanes(light_cone_radius(settings));
+        auto batches = rv::iota(0, (num_items + lanes - 1) / lanes) | r::to<std::vector>();
+        std::vector<run_result> results(work_items.size());
+        std::for_each(
+            std::execution::par,
+            batches.begin(),
+            batches.end(),
+            [&](int batch) {
+                int first = batch * lanes;
+                auto batch_results = run_batch(
+                    work_items, first, std::min(lanes, num_items - first), settings
+                );
+                std::move(batch_results.begin(), batch_results.end(), results.begin() + first);
+            }
+        );
+
+        auto indices = rv::iota(0, num_items) | r::to<std::vector>();
+        std::transform(
+            std::execution::par,
+            indices.begin(),
+            indices.end(),
+            snowflakes.begin(),
+            [&](int i) {
+                return score_run(std::move(results[i]), std::get<0>(work_items[i]), settings);
+            }
+        );
+        return snowflakes;
+    }
+
+    // whether the component labeler finds the same components in a hex grid as a search
+    // does, at both levels of adjacency.
+    bool labels_match(const asf::hex_grid& grid) {
+        auto labeled = grid_connectivity(grid);
+        auto direct = count_components(grid, false);
+        auto diagonal = count_components(grid, true);
+        return labeled.direct_components == direct.components &&
+            labeled.largest_direct_component == direct.largest &&
+            labeled.diagonal_components == diagonal.components &&
+            labeled.largest_diagonal_component == diagonal.largest;
+    }
+
+    // whether asf::k_craggy_masks agrees with is_craggy on every set of live neighbors.
+    bool craggy_masks_match() {
+        for (int mask = 0; mask < 64; ++mask) {
+            asf::hex_set live;
+            for (int k = 0; k < 6; ++k) {
+                auto [dx, dy] = asf::k_neighbor_offsets[k];
+                if (mask & (1 << k)) {
+                    live.insert({ dx, dy, -dx - dy });
+                }
+            }
+            if (asf::k_craggy_masks[mask] != is_craggy(live, { 0,0,0 })) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // reruns every candidate on the original implementation of the automaton and checks
+    // that the engine grew the same snowflakes and scored them the same, or zero if pruned,
+    // as well as the component labeler and the craggy mask table.
+    void cross_check(
+            const std::vector<std::tuple<asf::state_table, asf::hex_grid>>& work_items,
+            const std::vector<snowflake_info>& snowflakes,
+            const asf::settings& settings) {
+        auto indices = rv::iota(0, static_cast<int>(work_items.size())) | r::to<std::vector>();
+        bool matches = craggy_masks_match() && std::all_of(
+            std::execution::par,
+            indices.begin(),
+            indices.end(),
+            [&](int i) {
+                const auto& [tbl, seed] = work_items[i];
+                auto reference = run_sparse_automaton(seed, tbl, settings);
+                if (!labels_match(reference)) {
+                    return false;
+                }
+                if (snowflakes[i].pruned_at > 0) {
+                    return score_snowflake(reference, settings.score_params) == 0.0;
+                }
+                const auto& params = settings.score_params;
+                return reference == snowflakes[i].snowflake &&
+                    score_snowflake(reference, params) == snowflakes[i].score &&
+                    score_dense(reference, params) == snowflakes[i].score;
+            }
+        );
+        if (!matches) {
+            throw std::runtime_error("simulation engine disagrees with the reference implementation");
+        }
     }
 
     double mean_score(const std::vector<snowflake_info>& snowflakes) {
@@ -303,9 +833,13 @@ namespace {
     }
 
     std::vector<snowflake_info> do_next_generation(
-        const std::vector<state_table>& population,
+        const std::vector<asf::state_table>& population,
         const asf::settings& settings,
-        double last_score) {
+        double last_score,
+        pruning_stats& pruning,
+        gate_stats& gates,
+        component_stats& components,
+        asf::representation_use& usage) {
 
         double score = 0.0;
         std::vector<snowflake_info> snowflakes;
@@ -314,10 +848,10 @@ namespace {
         while (score <= last_score && tries < settings.tries_per_generation) {
             std::print(".");
 
-            std::vector<std::tuple<state_table, asf::hex_grid>> work_items;
+            std::vector<std::tuple<asf::state_table, asf::hex_grid>> work_items;
             for (int child = 0; child < settings.num_children; ++child) {
                 work_items.emplace_back(
-                    mix_state_tables(
+                    asf::mix_state_tables(
                         asf::random_element(population), asf::random_element(population)
                     ),
                     random_initial_grid(
@@ -328,17 +862,37 @@ namespace {
                 );
             }
 
-            snowflakes.resize(work_items.size());
-            std::transform(
-                std::execution::par,
-                work_items.begin(),
-                work_items.end(),
-                snowflakes.begin(),
-                [&](const auto& work_item) {
-                    const auto& [tbl, seed] = work_item;
-                    return generate_snowflake(seed, tbl, settings);
+            snowflakes = generate_snowflakes(work_items, settings);
+            if (settings.cross_check) {
+                cross_check(work_items, snowflakes, settings);
+            }
+            for (const auto& sf_info : snowflakes) {
+                ++pruning.candidates;
+                if (sf_info.pruned_at > 0) {
+                    ++pruning.pruned;
+                    pruning.total_pruned_at += sf_info.pruned_at;
+                } else {
+                    for (int k = 0; k <= std::min(sf_info.gates_passed, k_num_gates - 1); ++k) {
+                        ++gates.reached[k];
+                    }
+                    if (sf_info.gates_passed < k_num_gates) {
+                        ++gates.rejected[sf_info.gates_passed];
+                    }
                 }
-            );
+                // an empty snowflake has no components to take shares of.
+                if (sf_info.connectivity && !sf_info.snowflake.empty()) {
+                    const auto& c = *sf_info.connectivity;
+                    auto live_count = static_cast<double>(sf_info.snowflake.size());
+                    ++components.labeled;
+                    components.direct_components += c.direct_components;
+                    components.diagonal_components += c.diagonal_components;
+                    components.largest_direct_share += c.largest_direct_component / live_count;
+                    components.largest_diagonal_share += c.largest_diagonal_component / live_count;
+                }
+                usage.sparse_steps += sf_info.usage.sparse_steps;
+                usage.dense_steps += sf_info.usage.dense_steps;
+                usage.switches += sf_info.usage.switches;
+            }
 
             r::sort(snowflakes,
                 [](const snowflake_info& lhs, const snowflake_info& rhs) {
@@ -356,10 +910,12 @@ namespace {
     }
 }
 
-std::vector<asf::hex_grid> asf::grow_snowflakes(const settings& settings) {
+std::vector<asf::grown_snowflake> asf::grow_snowflakes(const settings& settings) {
     auto population = rv::iota(0, settings.population_sz) | rv::transform(
             [&](auto) {
-                return random_state_table(settings.state_table_density, settings.num_states);
+                return random_state_table(
+                    settings.state_table_density, settings.num_states, settings.neighborhood
+                );
             }
         ) | r::to<std::vector>();
 
@@ -367,7 +923,38 @@ std::vector<asf::hex_grid> asf::grow_snowflakes(const settings& settings) {
     std::vector<snowflake_info> snowflakes;
     for (int gen = 0; gen < settings.max_generations; ++gen) {
         std::print("    generation {}", gen + 1);
-        auto next_gen = do_next_generation(population, settings, last_score);
+        pruning_stats pruning = { 0, 0, 0 };
+        gate_stats gates = {};
+        component_stats components = {};
+        asf::representation_use usage = { 0, 0, 0 };
+        auto next_gen = do_next_generation(
+            population, settings, last_score, pruning, gates, components, usage
+        );
+        if (pruning.pruned > 0) {
+            std::println("      o pruned {} of {} candidates, on average at step {}",
+                pruning.pruned, pruning.candidates,
+                static_cast<double>(pruning.total_pruned_at) / pruning.pruned);
+        }
+        if (gates.reached[0] > 0) {
+            std::print("      o gates rejected");
+            for (int k = 0; k < k_num_gates; ++k) {
+                std::print("{} {} of {} on {}", (k > 0) ? "," : "", gates.rejected[k],
+                    gates.reached[k], asf::score_gate_name(settings.score_order[k]));
+            }
+            std::println("");
+        }
+        if (components.labeled > 0) {
+            double n = components.labeled;
+            std::println("      o labeled {} candidates: {:.1f} components on average, {:.1f} "
+                "with diagonal neighbors; the largest held {:.0f}%, {:.0f}% of the live cells",
+                components.labeled, components.direct_components / n,
+                components.diagonal_components / n, 100.0 * components.largest_direct_share / n,
+                100.0 * components.largest_diagonal_share / n);
+        }
+        if (settings.engine == asf::engine_type::adaptive) {
+            std::println("      o took {} sparse and {} dense steps, switching {} times",
+                usage.sparse_steps, usage.dense_steps, usage.switches);
+        }
         if (next_gen.empty()) {
             std::println("      no improvement in {} tries", settings.tries_per_generation);
             break;
@@ -386,10 +973,17 @@ std::vector<asf::hex_grid> asf::grow_snowflakes(const settings& settings) {
             settings.num_output_snowflakes
         ) | rv::transform(
             [](auto&& sf_info) {
-                return sf_info.snowflake;
+                return grown_snowflake{ sf_info.snowflake, sf_info.tbl };
             }
         ) | r::to<std::vector>();
 
 }
 
-
+// grows the snowflake, seeded with its final state, for the poster's iterations on the
+// out-of-core automaton, and prints it straight from the scratch file.
+void asf::render_poster(const grown_snowflake& snowflake, const settings& settings) {
+    int radius = max_radius(snowflake.grid) + settings.poster.iterations;
+    mapped_automaton automaton(snowflake.grid, snowflake.tbl, radius, settings.poster.file);
+    automaton.advance(settings.poster.iterations);
+    display(automaton.grid());
+}
@@ -1,6 +1,9 @@
 #pragma once
 
+#include "adaptive_grid.hpp"
 #include "hex_grid.hpp"
+#include "state_table.hpp"
+#include <string>
 #include <vector>
 
 namespace asf {
@@ -16,6 +19,37 @@ namespace asf {
         int    min_radius;
     };
 
+    // with a positive number of iterations, the best snowflake is grown that many more
+    // iterations out of core, in a scratch file at the given path, and printed as a poster.
+    struct poster_params {
+        int         iterations;
+        std::string file;
+    };
+
+    enum class engine_type {
+        sparse,
+        dense,
+        wedge,
+        bitplane,
+        simd,
+        batch,
+        packed,
+        hashlife,
+        tiled,
+        chunked,
+        adaptive,
+        delta
+    };
+
+    // the gates that a grown snowflake must pass to score at all. Scoring runs them in the
+    // configured order, stopping at the first that rejects the snowflake, before measuring
+    // the rest of it.
+    enum class score_gate {
+        radius,
+        density,
+        connectedness
+    };
+
     struct settings {
         int population_sz;
         int num_children;
@@ -27,8 +61,22 @@ namespace asf {
         int tries_per_generation;
         int num_iterations;
         int num_output_snowflakes;
+        engine_type engine;
+        neighborhood_type neighborhood;
+        bool stop_early;
+        bool prune;
+        bool cross_check;
+        switching_params switching;
+        poster_params poster;
+        std::vector<score_gate> score_order;
         snowflake_metric_params score_params;
     };
 
-    std::vector<hex_grid> grow_snowflakes(const settings& settings);
+    struct grown_snowflake {
+        hex_grid grid;
+        state_table tbl;
+    };
+
+    std::vector<grown_snowflake> grow_snowflakes(const settings& settings);
+    void render_poster(const grown_snowflake& snowflake, const settings& settings);
 }
\ No newline at end of file
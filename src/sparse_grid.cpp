@@ -0,0 +1,110 @@
+#include "sparse_grid.hpp"
+#include <algorithm>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    uint64_t cell_hash(const asf::hex_coords& hex, int state) {
+        return asf::mix_bits(asf::hash_vec3<int>()(hex) ^ asf::mix_bits(state));
+    }
+
+}
+
+asf::sparse_automaton::sparse_automaton(
+            const hex_grid& seed, const state_table& tbl, int) :
+        rules_(flat_rules(tbl)),
+        rules_stride_(tbl.stride()),
+        num_states_(tbl.num_states()),
+        neighborhood_(tbl.neighborhood()),
+        hash_(0) {
+
+    // the seed is everything that changed relative to an empty grid.
+    for (const auto& [hex, state] : seed) {
+        set(hex, state);
+        changed_.push_back(hex);
+    }
+}
+
+int asf::sparse_automaton::state_at(const hex_coords& hex) const {
+    auto i = state_.find(hex);
+    return (i != state_.end()) ? i->second : 0;
+}
+
+// the column of the rules for a cell: the sum of its direct neighbors, of its direct and
+// diagonal neighbors, or the pair of the two sums, as the neighborhood has it.
+int asf::sparse_automaton::column(const hex_coords& hex) const {
+    bool with_diagonals = neighborhood_ != neighborhood_type::direct;
+    int direct_sum = 0;
+    int diagonal_sum = 0;
+    int i = 0;
+    for (auto neighbor : neighbors(hex, with_diagonals)) {
+        (i++ < 6 ? direct_sum : diagonal_sum) += state_at(neighbor);
+    }
+    if (neighborhood_ == neighborhood_type::split) {
+        return split_sum(num_states_, direct_sum, diagonal_sum);
+    }
+    return direct_sum + diagonal_sum;
+}
+
+// keeps the hash and the number of live cells at each distance from the origin up to date.
+void asf::sparse_automaton::set(const hex_coords& hex, int state) {
+    auto old_state = state_at(hex);
+    auto ring = distance_from_origin(hex);
+    if (ring >= static_cast<int>(ring_counts_.size())) {
+        ring_counts_.resize(ring + 1, 0);
+    }
+    if (old_state > 0) {
+        hash_ -= cell_hash(hex, old_state);
+        --ring_counts_[ring];
+    }
+    if (state > 0) {
+        hash_ += cell_hash(hex, state);
+        ++ring_counts_[ring];
+        state_[hex] = state;
+    } else {
+        state_.erase(hex);
+    }
+}
+
+void asf::sparse_automaton::step() {
+    bool with_diagonals = neighborhood_ != neighborhood_type::direct;
+    frontier_.clear();
+    for (const auto& hex : changed_) {
+        frontier_.insert(hex);
+        for (auto neighbor : neighbors(hex, with_diagonals)) {
+            frontier_.insert(neighbor);
+        }
+    }
+
+    updates_.clear();
+    for (const auto& hex : frontier_) {
+        auto state = state_at(hex);
+        int next_state = rules_[state * rules_stride_ + column(hex)];
+        if (next_state != state) {
+            updates_.emplace_back(hex, next_state);
+        }
+    }
+
+    changed_.clear();
+    for (const auto& [hex, next_state] : updates_) {
+        set(hex, next_state);
+        changed_.push_back(hex);
+    }
+}
+
+uint64_t asf::sparse_automaton::hash() const {
+    return hash_;
+}
+
+asf::grid_stats asf::sparse_automaton::stats() const {
+    int radius = static_cast<int>(ring_counts_.size()) - 1;
+    while (radius > 0 && ring_counts_[radius] == 0) {
+        --radius;
+    }
+    return { static_cast<int>(state_.size()), std::max(radius, 0) };
+}
+
+asf::hex_grid asf::sparse_automaton::to_hex_grid() const {
+    return state_;
+}
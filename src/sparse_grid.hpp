@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <tuple>
+#include <vector>
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton on a hash map hex grid, updating it in place. A cell can
+    // only change if it or one of its neighbors changed in the previous step, so each step
+    // visits just the cells that changed and their neighbors rather than every live cell.
+    // The grid is unbounded, so the radius the other engines are built with goes unused.
+    // It also steps with the neighborhoods that have diagonal neighbors.
+
+    class sparse_automaton {
+    public:
+        sparse_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        int state_at(const hex_coords& hex) const;
+        int column(const hex_coords& hex) const;
+        void set(const hex_coords& hex, int state);
+
+        hex_grid state_;
+        std::vector<hex_coords> changed_;
+        hex_set frontier_;
+        std::vector<std::tuple<hex_coords, int>> updates_;
+        std::vector<uint8_t> rules_;
+        int rules_stride_;
+        int num_states_;
+        neighborhood_type neighborhood_;
+        uint64_t hash_;
+        std::vector<int> ring_counts_;
+    };
+
+}
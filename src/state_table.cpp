@@ -0,0 +1,96 @@
+#include "state_table.hpp"
+#include "util.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    template<int N>
+    asf::state_table mix(const asf::state_table& tbl1, const asf::state_table& tbl2) {
+        int size = N * asf::num_sums(N, tbl1.neighborhood());
+        asf::state_table child(N, tbl1.neighborhood());
+        const uint8_t* rules1 = tbl1.data();
+        const uint8_t* rules2 = tbl2.data();
+        uint8_t* out = child.data();
+        for (int i = 0; i < size; ++i) {
+            out[i] = asf::random_chance(0.5) ? rules1[i] : rules2[i];
+        }
+        return child;
+    }
+
+    template<int N>
+    asf::state_table random_table(double alive_prob, asf::neighborhood_type neighborhood) {
+        int size = N * asf::num_sums(N, neighborhood);
+        asf::state_table tbl(N, neighborhood);
+        uint8_t* out = tbl.data();
+        for (int i = 0; i < size; ++i) {
+            if (!asf::random_chance(1.0 - alive_prob)) {
+                out[i] = static_cast<uint8_t>(1 + asf::random_int(N - 1));
+            }
+        }
+        return tbl;
+    }
+
+}
+
+asf::state_table::state_table(int num_states, neighborhood_type neighborhood) :
+        num_states_(num_states),
+        neighborhood_(neighborhood),
+        rules_(num_states * num_sums(num_states, neighborhood), 0) {
+}
+
+int asf::state_table::num_states() const {
+    return num_states_;
+}
+
+asf::neighborhood_type asf::state_table::neighborhood() const {
+    return neighborhood_;
+}
+
+int asf::state_table::stride() const {
+    return num_sums(num_states_, neighborhood_);
+}
+
+uint8_t asf::state_table::operator()(int state, int sum) const {
+    return rules_[state * stride() + sum];
+}
+
+uint8_t& asf::state_table::operator()(int state, int sum) {
+    return rules_[state * stride() + sum];
+}
+
+const uint8_t* asf::state_table::data() const {
+    return rules_.data();
+}
+
+uint8_t* asf::state_table::data() {
+    return rules_.data();
+}
+
+asf::state_table asf::mix_state_tables(const state_table& tbl1, const state_table& tbl2) {
+    return with_num_states(tbl1.num_states(),
+        [&](auto n) {
+            return mix<n()>(tbl1, tbl2);
+        }
+    );
+}
+
+asf::state_table asf::random_state_table(double alive_prob, int num_states,
+        neighborhood_type neighborhood) {
+    return with_num_states(num_states,
+        [&](auto n) {
+            return random_table<n()>(alive_prob, neighborhood);
+        }
+    );
+}
+
+std::vector<uint8_t> asf::flat_rules(const state_table& tbl) {
+    std::vector<uint8_t> rules;
+    flat_rules(tbl, rules);
+    return rules;
+}
+
+void asf::flat_rules(const state_table& tbl, std::vector<uint8_t>& rules) {
+    rules.assign(tbl.data(), tbl.data() + tbl.num_states() * tbl.stride());
+    rules[0] = 0;
+}
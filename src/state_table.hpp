@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    constexpr int k_min_states = 2;
+    constexpr int k_max_states = 10;
+
+    // the neighbors whose states decide a cell's next state: its six direct neighbors, its
+    // direct and its six diagonal neighbors added up into one sum, or both of those with the
+    // sum of the direct neighbors and the sum of the diagonal ones kept apart.
+    enum class neighborhood_type {
+        direct,
+        extended,
+        split
+    };
+
+    // the number of distinct neighbor sums, 0 through 6 * (num_states - 1), rounded up to
+    // the 6 * num_states + 1 columns the state table has always had.
+    constexpr int num_sums(int num_states) {
+        return 6 * num_states + 1;
+    }
+
+    // the number of columns of a state table for the given neighborhood: the number of
+    // distinct sums of twelve neighbors, rounded up in the same way, or one column for each
+    // pair of a direct and a diagonal sum.
+    constexpr int num_sums(int num_states, neighborhood_type neighborhood) {
+        switch (neighborhood) {
+            case neighborhood_type::extended:
+                return 12 * num_states + 1;
+            case neighborhood_type::split:
+                return num_sums(num_states) * num_sums(num_states);
+            default:
+                return num_sums(num_states);
+        }
+    }
+
+    // the column of a split state table for the given direct and diagonal sums.
+    constexpr int split_sum(int num_states, int direct_sum, int diagonal_sum) {
+        return direct_sum * num_sums(num_states) + diagonal_sum;
+    }
+
+    // how far a pattern can grow in one step: one cell, or two when the diagonal
+    // neighbors, two cells away, count.
+    constexpr int reach(neighborhood_type neighborhood) {
+        return (neighborhood == neighborhood_type::direct) ? 1 : 2;
+    }
+
+    // the rules of an automaton: the next state of a cell indexed by its current state and
+    // the sum of its neighbors' states, stored as one contiguous block of bytes with a row
+    // of num_sums(num_states, neighborhood) entries per state.
+
+    class state_table {
+    public:
+        state_table() = default;
+        explicit state_table(int num_states,
+            neighborhood_type neighborhood = neighborhood_type::direct);
+
+        int num_states() const;
+        neighborhood_type neighborhood() const;
+        int stride() const;
+        uint8_t operator()(int state, int sum) const;
+        uint8_t& operator()(int state, int sum);
+        const uint8_t* data() const;
+        uint8_t* data();
+
+    private:
+        int num_states_ = 0;
+        neighborhood_type neighborhood_ = neighborhood_type::direct;
+        std::vector<uint8_t> rules_;
+    };
+
+    state_table mix_state_tables(const state_table& tbl1, const state_table& tbl2);
+    state_table random_state_table(double alive_prob, int num_states,
+        neighborhood_type neighborhood = neighborhood_type::direct);
+
+    // the state table as bytes, for the dense engines. A dead cell with no live neighbors
+    // always stays dead, as it does in the sparse implementation which only ever visits live
+    // cells and their neighbors.
+    std::vector<uint8_t> flat_rules(const state_table& tbl);
+    void flat_rules(const state_table& tbl, std::vector<uint8_t>& rules);
+
+    // calls fn with a std::integral_constant holding num_states, so that code that depends
+    // on the number of states can be specialized for each supported count and have its
+    // loops over states and sums unrolled and its strides folded into constants.
+    template<int N = k_min_states, typename F>
+    decltype(auto) with_num_states(int num_states, F&& fn) {
+        if constexpr (N < k_max_states) {
+            if (num_states != N) {
+                return with_num_states<N + 1>(num_states, std::forward<F>(fn));
+            }
+        } else if (num_states != N) {
+            throw std::runtime_error("num_states must be between 2 and 10");
+        }
+        return fn(std::integral_constant<int, N>{});
+    }
+
+}
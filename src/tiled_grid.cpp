@@ -0,0 +1,120 @@
+#include "tiled_grid.hpp"
+#include <algorithm>
+#include <cstring>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    // 64x64 tiles with a halo of four cells take two scratch buffers of 5KB each, which
+    // leaves room in L1 for the rows of the grids being read and written.
+    constexpr int k_tile_size = 64;
+    constexpr int k_block_steps = 4;
+
+}
+
+asf::tiled_automaton::tiled_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        current_(context_.buffers().current),
+        next_(context_.buffers().next),
+        rules_(context_.buffers().rules),
+        step_row_(row_kernel_for(tbl.num_states())),
+        extent_(max_radius(seed)),
+        pitch_(k_tile_size + 2 * k_block_steps),
+        scratch_(context_.buffers().tile),
+        scratch_next_(context_.buffers().next_tile) {
+
+    current_.reset(seed, radius);
+    next_.reset(radius);
+    flat_rules(tbl, rules_);
+    scratch_.assign(pitch_ * pitch_, 0);
+    scratch_next_.assign(pitch_ * pitch_, 0);
+}
+
+int asf::tiled_automaton::block_steps() const {
+    return k_block_steps;
+}
+
+// advances the tile of the next grid whose top left cell is (tile_x, tile_y) by `steps`
+// steps from the current grid. Scratch cell (col, row) holds grid cell
+// (tile_x - steps + col, tile_y - steps + row).
+void asf::tiled_automaton::advance_tile(int tile_x, int tile_y, int width, int height,
+        int steps) {
+    int cols = width + 2 * steps;
+    int rows = height + 2 * steps;
+    // the farthest row and column of the grid, guard ring included.
+    int limit = (current_.stride() - 1) / 2;
+
+    for (int row = 0; row < rows; ++row) {
+        uint8_t* out = &scratch_[row * pitch_];
+        std::fill(out, out + cols, 0);
+        int y = tile_y - steps + row;
+        if (y < -limit || y > limit) {
+            continue;
+        }
+        int first_x = std::max(tile_x - steps, -limit);
+        int last_x = std::min(tile_x - steps + cols - 1, limit);
+        if (first_x <= last_x) {
+            std::memcpy(out + (first_x - tile_x + steps),
+                current_.data() + current_.index({ first_x, y, -first_x - y }),
+                last_x - first_x + 1);
+        }
+    }
+
+    // step s only computes the cells at least s cells in from the edge of the scratch
+    // area; those only depend on cells at least s - 1 cells in, which are still exact.
+    uint8_t* src = scratch_.data();
+    uint8_t* dst = scratch_next_.data();
+    for (int s = 1; s <= steps; ++s) {
+        for (int row = s; row < rows - s; ++row) {
+            step_row_(src, dst, pitch_, rules_.data(),
+                row * pitch_ + s, row * pitch_ + cols - 1 - s);
+        }
+        std::swap(src, dst);
+    }
+
+    for (int row = 0; row < height; ++row) {
+        int y = tile_y + row;
+        std::memcpy(next_.data() + next_.index({ tile_x, y, -tile_x - y }),
+            src + (row + steps) * pitch_ + steps, width);
+    }
+}
+
+void asf::tiled_automaton::advance(int steps) {
+    int extent = std::min(extent_ + steps, current_.radius());
+    for (int tile_y = -extent; tile_y <= extent; tile_y += k_tile_size) {
+        for (int tile_x = -extent; tile_x <= extent; tile_x += k_tile_size) {
+            int width = std::min(k_tile_size, extent - tile_x + 1);
+            int height = std::min(k_tile_size, extent - tile_y + 1);
+            // tiles wholly outside of the hexagon, in its two empty corners of the
+            // bounding square, stay empty.
+            if (tile_x + tile_y > extent || tile_x + width + tile_y + height - 2 < -extent) {
+                continue;
+            }
+            advance_tile(tile_x, tile_y, width, height, steps);
+        }
+    }
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+void asf::tiled_automaton::step() {
+    advance(1);
+}
+
+uint64_t asf::tiled_automaton::hash() const {
+    return current_.hash(extent_);
+}
+
+asf::grid_stats asf::tiled_automaton::stats() const {
+    return current_.stats(extent_);
+}
+
+const asf::dense_grid& asf::tiled_automaton::grid() const {
+    return current_;
+}
+
+asf::hex_grid asf::tiled_automaton::to_hex_grid() const {
+    return current_.to_hex_grid();
+}
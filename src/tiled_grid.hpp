@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton on the same pair of dense grids as dense_automaton, several
+    // steps at a time: each tile is copied with a halo as wide as the number of steps into a
+    // scratch buffer, stepped there while in cache and written back.
+
+    class tiled_automaton {
+    public:
+        tiled_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        int block_steps() const;
+        void advance(int steps);
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        const dense_grid& grid() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        void advance_tile(int tile_x, int tile_y, int width, int height, int steps);
+
+        simulation_context context_;
+        dense_grid& current_;
+        dense_grid& next_;
+        std::vector<uint8_t>& rules_;
+        row_kernel step_row_;
+        int extent_;
+        int pitch_;
+        std::vector<uint8_t>& scratch_;
+        std::vector<uint8_t>& scratch_next_;
+    };
+
+}
@@ -1,14 +1,114 @@
 #include "util.hpp"
+#include "simd_grid.hpp"
 #include "third-party/json.hpp"
 #include <random>
 #include <fstream>
 #include <stdexcept>
 #include <print>
+#include <array>
+#include <algorithm>
 
 namespace {
 
     static std::random_device g_rd;
     static std::mt19937 g_gen(g_rd());
+
+    constexpr std::array<std::pair<asf::engine_type, const char*>, 12> k_engine_names = { {
+        {asf::engine_type::sparse, "sparse"},
+        {asf::engine_type::dense, "dense"},
+        {asf::engine_type::wedge, "wedge"},
+        {asf::engine_type::bitplane, "bitplane"},
+        {asf::engine_type::simd, "simd"},
+        {asf::engine_type::batch, "batch"},
+        {asf::engine_type::packed, "packed"},
+        {asf::engine_type::hashlife, "hashlife"},
+        {asf::engine_type::tiled, "tiled"},
+        {asf::engine_type::chunked, "chunked"},
+        {asf::engine_type::adaptive, "adaptive"},
+        {asf::engine_type::delta, "delta"}
+    } };
+
+    asf::engine_type engine_from_name(const std::string& name) {
+        for (const auto& [engine, engine_name] : k_engine_names) {
+            if (name == engine_name) {
+                return engine;
+            }
+        }
+        throw std::runtime_error("unknown engine: " + name);
+    }
+
+    constexpr std::array<std::pair<asf::neighborhood_type, const char*>, 3> k_neighborhood_names = { {
+        {asf::neighborhood_type::direct, "direct"},
+        {asf::neighborhood_type::extended, "extended"},
+        {asf::neighborhood_type::split, "split"}
+    } };
+
+    asf::neighborhood_type neighborhood_from_name(const std::string& name) {
+        for (const auto& [neighborhood, neighborhood_name] : k_neighborhood_names) {
+            if (name == neighborhood_name) {
+                return neighborhood;
+            }
+        }
+        throw std::runtime_error("unknown neighborhood: " + name);
+    }
+
+    std::string neighborhood_name(asf::neighborhood_type neighborhood) {
+        for (const auto& [n, neighborhood_name] : k_neighborhood_names) {
+            if (n == neighborhood) {
+                return neighborhood_name;
+            }
+        }
+        return "unknown";
+    }
+
+    constexpr std::array<std::pair<asf::score_gate, const char*>, 3> k_gate_names = { {
+        {asf::score_gate::radius, "radius"},
+        {asf::score_gate::density, "density"},
+        {asf::score_gate::connectedness, "connectedness"}
+    } };
+
+    asf::score_gate gate_from_name(const std::string& name) {
+        for (const auto& [gate, gate_name] : k_gate_names) {
+            if (name == gate_name) {
+                return gate;
+            }
+        }
+        throw std::runtime_error("unknown score gate: " + name);
+    }
+
+    // the gates that cost nothing come first: the radius and live count of a snowflake are
+    // tracked by the engines as they run, while connectedness needs a pass over the grid.
+    const std::vector<asf::score_gate> k_default_score_order = {
+        asf::score_gate::radius,
+        asf::score_gate::density,
+        asf::score_gate::connectedness
+    };
+
+    std::vector<std::string> default_score_order_names() {
+        std::vector<std::string> names;
+        for (auto gate : k_default_score_order) {
+            names.push_back(asf::score_gate_name(gate));
+        }
+        return names;
+    }
+
+    std::string engine_name(asf::engine_type engine) {
+        for (const auto& [e, engine_name] : k_engine_names) {
+            if (e == engine) {
+                return engine_name;
+            }
+        }
+        return "unknown";
+    }
+}
+
+std::string asf::score_gate_name(score_gate gate) {
+    for (const auto& [g, gate_name] : k_gate_names) {
+        if (g == gate) {
+            return gate_name;
+        }
+    }
+    return "unknown";
 }
 
 int asf::random_int(int n) {
@@ -52,6 +152,9 @@ asf::settings asf::load_settings_from_file(const std::string& path) {
 	}
 
     asf::settings s;
+    std::string engine;
+    std::string neighborhood;
+    std::vector<std::string> score_order;
     try {
         nlohmann::json j;
         file >> j;
@@ -66,6 +169,22 @@ asf::settings asf::load_settings_from_file(const std::string& path) {
         s.tries_per_generation = j.at("tries_per_generation").get<int>();
         s.num_iterations = j.at("num_iterations").get<int>();
         s.num_output_snowflakes = j.at("num_output_snowflakes").get<int>();
+        engine = j.value("engine", "dense");
+        neighborhood = j.value("neighborhood", "direct");
+        s.stop_early = j.value("stop_early", true);
+        s.prune = j.value("prune", true);
+        s.cross_check = j.value("cross_check", false);
+
+        const auto& sw = j.value("switching", nlohmann::json::object());
+        s.switching.dense_fill_ratio = sw.value("dense_fill_ratio", 0.05);
+        s.switching.sparse_fill_ratio = sw.value("sparse_fill_ratio", 0.02);
+        s.switching.min_dense_radius = sw.value("min_dense_radius", 8);
+
+        const auto& poster = j.value("poster", nlohmann::json::object());
+        s.poster.iterations = poster.value("iterations", 0);
+        s.poster.file = poster.value("file", "snowflake_poster.tmp");
+
+        score_order = j.value("score_order", default_score_order_names());
 
         const auto& sp = j.at("score_params");
         s.score_params.connectedness_weight = sp.at("connectedness_weight").get<double>();
@@ -76,8 +195,43 @@ asf::settings asf::load_settings_from_file(const std::string& path) {
         s.score_params.max_density = sp.at("max_density").get<double>();
         s.score_params.max_radius = sp.at("max_radius").get<int>();
         s.score_params.min_radius = sp.at("min_radius").get<int>();
-    } catch (...) {
-        throw std::runtime_error("bad JSON settings.");
+    } catch (const nlohmann::json::exception& e) {
+        throw std::runtime_error(std::string("bad JSON settings: ") + e.what());
+    }
+
+    // the names and ranges are checked once the JSON has been read, so that their own
+    // messages reach the user.
+    s.engine = engine_from_name(engine);
+    s.neighborhood = neighborhood_from_name(neighborhood);
+    if (s.num_states < 2 || s.num_states > asf::k_max_states) {
+        throw std::runtime_error(
+            "num_states must be between 2 and " + std::to_string(asf::k_max_states)
+        );
+    }
+    for (const auto& name : score_order) {
+        s.score_order.push_back(gate_from_name(name));
+    }
+
+    // only the dense and sparse engines, and the original implementation that cross_check
+    // compares them with, can step with the neighborhoods with diagonal neighbors.
+    if (s.neighborhood != asf::neighborhood_type::direct) {
+        if (s.engine != asf::engine_type::dense && s.engine != asf::engine_type::sparse) {
+            throw std::runtime_error(
+                "the " + neighborhood_name(s.neighborhood) +
+                " neighborhood needs the dense or sparse engine"
+            );
+        }
+        if (s.poster.iterations > 0) {
+            throw std::runtime_error("posters need the direct neighborhood");
+        }
+    }
+
+    for (const auto& [gate, name] : k_gate_names) {
+        if (std::ranges::count(s.score_order, gate) != 1) {
+            throw std::runtime_error(
+                std::string("score_order must name the ") + name + " gate exactly once"
+            );
+        }
     }
 	return s;
 }
@@ -96,6 +250,43 @@ void asf::print_settings(const asf::settings& s) {
     println("      tries_per_generation: {}", s.tries_per_generation);
     println("      num_iterations: {}", s.num_iterations);
     println("      num_output_snowflakes: {}", s.num_output_snowflakes);
+    println("      engine: {}", engine_name(s.engine));
+    if (s.neighborhood != asf::neighborhood_type::direct) {
+        println("      neighborhood: {}", neighborhood_name(s.neighborhood));
+    }
+    if (s.engine == asf::engine_type::simd) {
+        println("      simd kernel: {}", asf::simd_kernel_name());
+    }
+    if (s.engine == asf::engine_type::adaptive) {
+        const auto& sw = s.switching;
+        println("      switching: {{");
+        println("        dense_fill_ratio: {}", sw.dense_fill_ratio);
+        println("        sparse_fill_ratio: {}", sw.sparse_fill_ratio);
+        println("        min_dense_radius: {}", sw.min_dense_radius);
+        println("      }}");
+    }
+    if (s.poster.iterations > 0) {
+        println("      poster: {{");
+        println("        iterations: {}", s.poster.iterations);
+        println("        file: {}", s.poster.file);
+        println("      }}");
+    }
+    if (!s.stop_early) {
+        println("      stop_early: false");
+    }
+    if (!s.prune) {
+        println("      prune: false");
+    }
+    if (s.cross_check) {
+        println("      cross_check: true");
+    }
+    if (s.score_order != k_default_score_order) {
+        print("      score_order:");
+        for (auto gate : s.score_order) {
+            print(" {}", score_gate_name(gate));
+        }
+        println("");
+    }
 
     const auto& p = s.score_params;
     println("      score parameters: {{");
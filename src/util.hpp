@@ -9,6 +9,7 @@ namespace asf {
     void report_error(const std::string& msg = {});
     settings load_settings_from_file(const std::string& path);
     void print_settings(const asf::settings& s);
+    std::string score_gate_name(score_gate gate);
     void seed_rand_generator(unsigned int seed);
     int random_int(int n);
     bool random_chance(double p);
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
 #include <unordered_set>
 #include <unordered_map>
 
@@ -47,6 +50,31 @@ namespace asf {
         seed ^= hasher(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
 
+    // scrambles the bits of x thoroughly (the splitmix64 finalizer), for hashes that are
+    // built by adding up the hashes of their parts in any order.
+    inline uint64_t mix_bits(uint64_t x) {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // a hash of a block of memory that is mostly zeros: only nonzero eight byte words
+    // contribute, each mixed with its position. The block may be part of a larger one that
+    // starts `offset` bytes earlier, a multiple of eight, which hashes the same as long as
+    // the rest of it is zero.
+    inline uint64_t hash_sparse_bytes(const void* data, size_t size, size_t offset = 0) {
+        auto bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 0;
+        for (size_t i = 0; i < size; i += sizeof(uint64_t)) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes + i, std::min(sizeof(uint64_t), size - i));
+            if (word != 0) {
+                hash += mix_bits(word ^ mix_bits(offset + i));
+            }
+        }
+        return hash;
+    }
+
     template<typename T>
     struct hash_vec2 {
         size_t operator()(const vec2<T>& pt) const {
@@ -0,0 +1,152 @@
+#include "wedge_grid.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace {
+
+    bool in_wedge(const asf::hex_coords& hex) {
+        return hex.x >= 0 && hex.z >= hex.x;
+    }
+
+    // the cell of the wedge that hex is equivalent to under the symmetries of the snowflake.
+    asf::hex_coords canonical(const asf::hex_coords& hex) {
+        for (int i = 0; i < 6; ++i) {
+            auto rotated = asf::rotate(hex, i);
+            if (in_wedge(rotated)) {
+                return rotated;
+            }
+            auto flipped = asf::flip_horz(rotated);
+            if (in_wedge(flipped)) {
+                return flipped;
+            }
+        }
+        return hex;
+    }
+
+    // the number of cells of the full snowflake that a wedge cell stands for: the center is
+    // alone, cells on the wedge's two edges have six images, and all other cells twelve.
+    int multiplicity(const asf::hex_coords& hex) {
+        if (hex.y == 0) {
+            return 1;
+        }
+        return (hex.x == 0 || hex.x == hex.z) ? 6 : 12;
+    }
+
+    // the wedge occupies rows y = 0 down to y = -radius and, within row y, the columns
+    // x = 0 up to x = -y / 2. Calls fn(hex) for each of its cells.
+    template<typename F>
+    void for_each_wedge_cell(int radius, F fn) {
+        for (int y = 0; y >= -radius; --y) {
+            for (int x = 0; x <= -y / 2; ++x) {
+                fn(asf::hex_coords{ x, y, -x - y });
+            }
+        }
+    }
+
+}
+
+asf::wedge_automaton::wedge_automaton(
+            const hex_grid& seed, const state_table& tbl, int radius) :
+        radius_(radius),
+        stride_(radius / 2 + 3),
+        current_((radius + 3) * stride_, 0),
+        next_((radius + 3) * stride_, 0),
+        rules_(flat_rules(tbl)),
+        step_row_(row_kernel_for(tbl.num_states())),
+        extent_(0) {
+
+    hex_set ghosts;
+    for_each_wedge_cell(radius_,
+        [&](const hex_coords& hex) {
+            for (auto neighbor : neighbors(hex, false)) {
+                if (in_wedge(neighbor) || distance_from_origin(neighbor) > radius_ ||
+                        ghosts.contains(neighbor)) {
+                    continue;
+                }
+                ghosts.insert(neighbor);
+                ghosts_.emplace_back(index(neighbor), index(canonical(neighbor)));
+            }
+        }
+    );
+
+    for (const auto& [hex, state] : seed) {
+        if (!in_wedge(hex)) {
+            continue;
+        }
+        if (distance_from_origin(hex) > radius_) {
+            throw std::runtime_error("cell lies outside of wedge grid");
+        }
+        current_[index(hex)] = static_cast<uint8_t>(state);
+        extent_ = std::max(extent_, distance_from_origin(hex));
+    }
+    update_ghosts(current_);
+}
+
+int asf::wedge_automaton::index(const hex_coords& hex) const {
+    return (hex.y + radius_ + 1) * stride_ + (hex.x + 1);
+}
+
+void asf::wedge_automaton::update_ghosts(std::vector<uint8_t>& cells) const {
+    for (auto [ghost, source] : ghosts_) {
+        cells[ghost] = cells[source];
+    }
+}
+
+void asf::wedge_automaton::step() {
+    int extent = std::min(extent_ + 1, radius_);
+    int stride = stride_;
+    const uint8_t* src = current_.data();
+    uint8_t* dst = next_.data();
+    const uint8_t* rules = rules_.data();
+
+    for (int y = 0; y >= -extent; --y) {
+        int first = index({ 0, y, -y });
+        step_row_(src, dst, stride, rules, first, first + (-y / 2));
+    }
+    update_ghosts(next_);
+
+    std::swap(current_, next_);
+    extent_ = extent;
+}
+
+// only the rows from y = -extent_ up to the ghosts at y = 1, the last row of the buffer, can
+// hold live cells, so hashing them hashes the same as hashing the whole buffer.
+uint64_t asf::wedge_automaton::hash() const {
+    size_t first = static_cast<size_t>(radius_ + 1 - extent_) * stride_;
+    first -= first % sizeof(uint64_t);
+    return hash_sparse_bytes(&current_[first], current_.size() - first, first);
+}
+
+asf::grid_stats asf::wedge_automaton::stats() const {
+    grid_stats stats = { 0, 0 };
+    for_each_wedge_cell(extent_,
+        [&](const hex_coords& hex) {
+            if (current_[index(hex)] == 0) {
+                return;
+            }
+            stats.live_count += multiplicity(hex);
+            stats.radius = std::max(stats.radius, -hex.y);
+        }
+    );
+    return stats;
+}
+
+asf::hex_grid asf::wedge_automaton::to_hex_grid() const {
+    hex_grid grid;
+    for_each_wedge_cell(extent_,
+        [&](const hex_coords& hex) {
+            auto state = current_[index(hex)];
+            if (state == 0) {
+                return;
+            }
+            auto flipped = flip_horz(hex);
+            for (int i = 0; i < 6; ++i) {
+                grid[rotate(hex, i)] = state;
+                grid[rotate(flipped, i)] = state;
+            }
+        }
+    );
+    return grid;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <tuple>
+#include "dense_grid.hpp"
+#include "hex_grid.hpp"
+#include "state_table.hpp"
+
+/*------------------------------------------------------------------------------------------------*/
+
+namespace asf {
+
+    // runs the cellular automaton on a snowflake with full sixfold rotational and mirror
+    // symmetry, storing only the 30 degree wedge x >= 0, z >= x and a ring of ghost cells
+    // that mirror it. The seed must be symmetric; its cells outside of the wedge are ignored.
+
+    class wedge_automaton {
+    public:
+        wedge_automaton(const hex_grid& seed, const state_table& tbl, int radius);
+
+        void step();
+        uint64_t hash() const;
+        grid_stats stats() const;
+        hex_grid to_hex_grid() const;
+
+    private:
+        int index(const hex_coords& hex) const;
+        void update_ghosts(std::vector<uint8_t>& cells) const;
+
+        int radius_;
+        int stride_;
+        std::vector<uint8_t> current_;
+        std::vector<uint8_t> next_;
+        std::vector<std::tuple<int, int>> ghosts_;
+        std::vector<uint8_t> rules_;
+        row_kernel step_row_;
+        int extent_;
+    };
+
+}